@@ -0,0 +1,193 @@
+/*************************************************************
+ * elevator.c  — controller FSM (MEGA, also built for Linux)
+ *
+ * Talks to the board only through hal.h and telemetry.h; keys
+ * and the emergency latch are read via record.h.  Each floor
+ * and each change of state is saved to EEPROM (persist.h); trips,
+ * faults and emergencies go to the event log (evlog.h).
+ *************************************************************/
+#include <stdio.h>
+#include "elevator.h"
+#include "hal.h"
+#include "evlog.h"
+#include "persist.h"
+#include "protocol.h"
+#include "record.h"
+#include "telemetry.h"
+#include "trace.h"
+
+/*----------------------------------------------------------------------
+  1.  UNO command helpers
+  --------------------------------------------------------------------*/
+static inline void spi_cmd(uint8_t cmd)
+{
+    hal_spi_frame(&cmd, 1);
+    tlm_spi(cmd);
+}
+
+/* Opcode + arguments in one SS-low frame (protocol.h) */
+static void spi_frame(const uint8_t *b, uint8_t n)
+{
+    hal_spi_frame(b, n);
+    tlm_spi(b[0]);
+}
+
+/* Gamma-corrected fade on the UNO; *t10* in 10 ms steps */
+static void led_fade(uint8_t mask, uint8_t level, uint8_t t10)
+{
+    const uint8_t f[4] = { CMD_LED_FADE, mask, level, t10 };
+    spi_frame(f, sizeof f);
+}
+
+/* Blink pattern run by the UNO: *count* cycles of *p10* × 10 ms,
+   ending off.  Returns at once; STATUS_LED_BLINKING reports it.  */
+static void led_blink(uint8_t mask, uint8_t count, uint8_t p10)
+{
+    const uint8_t f[4] = { CMD_LED_BLINK, mask, count, p10 };
+    spi_frame(f, sizeof f);
+}
+
+/* One-line wrappers for readability */
+static inline void led_movement_on (void){ spi_cmd(CMD_MOVEMENT_LED_ON); }
+static inline void led_movement_off(void){ spi_cmd(CMD_MOVEMENT_LED_OFF);}
+static inline void led_door_on      (void){ led_fade(LED_MASK_DOOR, 255, 40);  } /* 0.4 s */
+static inline void led_door_off     (void){ led_fade(LED_MASK_DOOR, 0,  100);  } /* 1 s   */
+static inline void audio_stop       (void){ spi_cmd(CMD_AUDIO_STOP);     }
+
+/* Send a query, then clock its n-byte reply out with CMD_READ. */
+static void uno_query(uint8_t cmd, uint8_t *buf, uint8_t n)
+{
+    spi_cmd(cmd);
+    while (n--) *buf++ = hal_spi_reply(CMD_READ);
+}
+
+/*----------------------------------------------------------------------
+  2.  States
+  --------------------------------------------------------------------*/
+void elevator_init(elevator_t *e)
+{
+    e->current_floor = 0;
+    e->target_floor  = 0;
+    e->state         = ST_IDLE;
+    e->booting       = 1;
+}
+
+void elevator_step(elevator_t *e)
+{
+    const state_t prev = e->state;
+
+    switch (e->state)
+    {
+    /*-------------------------------------------------- IDLE ----*/
+    case ST_IDLE: {
+        const uint16_t t0 = tlm_now();
+        hal_lcd_clear();
+        hal_lcd_puts("Choose floor:");
+        tlm_timing(TLM_PROBE_PROMPT_LCD, t0);
+        if (e->booting) tlm_timing(TLM_PROBE_BOOT, 0); /* Timer-1 from 0 */
+
+        char d1, d2;
+        do { d1 = rec_key_get(); tlm_key(d1); } while (d1 < '0' || d1 > '9');
+        hal_lcd_gotoxy(0,1); hal_lcd_putc(d1);
+
+        do { d2 = rec_key_get(); tlm_key(d2); } while (d2 < '0' || d2 > '9');
+        hal_lcd_putc(d2);
+
+        e->target_floor = (d1-'0')*10 + (d2-'0');
+
+        if (e->target_floor == e->current_floor) {    /* FAULT */
+            evlog_add(LOG_FAULT, e->current_floor, e->target_floor);
+            led_blink(LED_MASK_MOVEMENT, 3, 100);     /* 3 × 1 s  */
+        } else {
+            e->state = ST_MOVING;
+        }
+    } break;
+
+    /*------------------------------------------------ MOVING ----*/
+    case ST_MOVING: {
+        led_movement_on();
+        const uint8_t from = e->current_floor;
+        const int8_t dir = (e->target_floor > e->current_floor) ?  1 : -1;
+
+        while (e->current_floor != e->target_floor && !rec_emg_pending())
+        {
+            e->current_floor += dir;
+            persist_save(e);
+            tlm_floor(e->current_floor, e->target_floor);
+
+            const uint16_t t0 = tlm_now();
+            hal_lcd_gotoxy(0,1);
+            char buf[17];
+            sprintf(buf,"Floor %02u", e->current_floor);
+            hal_lcd_puts(buf);
+            tlm_timing(TLM_PROBE_FLOOR_LCD, t0);
+
+            spi_cmd(CMD_DING);          /* arrival chime          */
+            hal_wait_ms(FLOOR_TIME_MS);
+        }
+        led_movement_off();
+        const uint8_t emg = rec_emg_pending();
+        if (emg) tlm_timing(TLM_PROBE_EMG_REACT, hal_emg_stamp());
+        if (emg) evlog_add(LOG_EMERGENCY, e->current_floor, e->target_floor);
+        else     evlog_add(LOG_TRIP, from, e->current_floor);
+        e->state = emg ? ST_EMERGENCY : ST_DOOR;
+    } break;
+
+    /*------------------------------------------------- DOOR -----*/
+    case ST_DOOR:
+        led_door_on();
+        hal_lcd_clear(); hal_lcd_puts("Door opening...");
+        hal_wait_ms(DOOR_OPEN_MS);
+        led_door_off();
+        hal_lcd_clear(); hal_lcd_puts("Door closed");
+        hal_wait_ms(DOOR_CLOSED_MS);
+        e->state = ST_IDLE;
+        break;
+
+    /*-------------------------------------------- EMERGENCY -----*/
+    case ST_EMERGENCY: {
+        rec_emg_clear();                    /* clear latch        */
+        hal_lcd_clear(); hal_lcd_puts("!!! EMERGENCY !!!");
+
+        /* one-shot melody  + 3 blinks, both run by the UNO */
+        spi_cmd(CMD_BUZZER_PLAY_ONESHOT);
+        led_blink(LED_MASK_MOVEMENT, 3, 60);          /* 3 × 0.6 s */
+
+        /* the blinks no longer hold the FSM: keep the alarm on line 1 */
+        hal_lcd_gotoxy(0,1); hal_lcd_puts("Press # to open");
+        char key;
+        do { key = rec_key_get(); tlm_key(key); } while (key != '#');
+
+        led_door_on();
+        audio_stop();                       /* cut melody short   */
+        spi_cmd(CMD_DING);                  /* door chime         */
+        hal_lcd_clear(); hal_lcd_puts("Door opening...");
+        hal_wait_ms(DOOR_OPEN_MS);
+
+        led_door_off();
+        hal_lcd_clear(); hal_lcd_puts("Door closed");
+        hal_wait_ms(DOOR_CLOSED_MS);
+        e->state = ST_IDLE;
+    } break;
+    }
+
+    if (e->state != prev) {
+        persist_save(e);
+        TRACE(TR_FSM_STATE, e->state);
+        tlm_state(prev, e->state);
+        if (e->state == ST_IDLE) {          /* UNO sleep stats/trip */
+            uint8_t ps[POWER_STATS_LEN];
+            uno_query(CMD_POWER_STATS, ps, sizeof ps);
+            tlm_emit(TLM_POWER, ps, sizeof ps);
+
+            uint8_t st[1 + STACK_STATS_LEN];  /* stack high water   */
+            st[0] = TLM_BOARD_MEGA;
+            hal_stack_stats(st + 1);
+            tlm_emit(TLM_STACK, st, sizeof st);
+            st[0] = TLM_BOARD_UNO;
+            uno_query(CMD_STACK_STATS, st + 1, STACK_STATS_LEN);
+            tlm_emit(TLM_STACK, st, sizeof st);
+        }
+    }
+    e->booting = 0;
+}
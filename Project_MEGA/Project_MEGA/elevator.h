@@ -0,0 +1,39 @@
+/*************************************************************
+ * elevator.h  — controller FSM, hardware-independent (hal.h)
+ *************************************************************/
+#ifndef ELEVATOR_H
+#define ELEVATOR_H
+
+#include <stdint.h>
+
+#if ELEVATOR_TUNING
+/* Host sweeps (tools/sweep) vary the timing per thread at run time */
+typedef struct {
+    uint16_t floor_ms, door_open_ms, door_closed_ms;
+} elevator_tuning_t;
+
+extern __thread elevator_tuning_t elevator_tuning;
+
+#define FLOOR_TIME_MS  (elevator_tuning.floor_ms)
+#define DOOR_OPEN_MS   (elevator_tuning.door_open_ms)
+#define DOOR_CLOSED_MS (elevator_tuning.door_closed_ms)
+#else
+#define FLOOR_TIME_MS  250                   /* sim-travel per floor  */
+#define DOOR_OPEN_MS   5000
+#define DOOR_CLOSED_MS 1500
+#endif
+
+typedef enum { ST_IDLE, ST_MOVING,
+               ST_DOOR, ST_EMERGENCY } state_t;
+
+typedef struct {
+    uint8_t  current_floor;
+    uint8_t  target_floor;
+    state_t  state;
+    uint8_t  booting;                  /* no step finished since reset */
+} elevator_t;
+
+void elevator_init(elevator_t *e);
+void elevator_step(elevator_t *e);     /* run the current state once */
+
+#endif /* ELEVATOR_H */
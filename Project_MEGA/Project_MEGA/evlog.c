@@ -0,0 +1,45 @@
+/*************************************************************
+ * evlog.c  — trip and event log in EEPROM (see evlog.h)
+ *************************************************************/
+#include "evlog.h"
+#include "hal.h"
+#include "nvring.h"
+#include "telemetry.h"
+
+static HAL_PER_THREAD nvring_t ring = NVRING(EVLOG_ADDR, EVLOG_SLOTS, EVLOG_LEN, EVLOG_TAG);
+
+void evlog_init(void)
+{
+    nvring_open(&ring);
+}
+
+void evlog_add(uint8_t kind, uint8_t a, uint8_t b)
+{
+    const uint8_t d[EVLOG_LEN] = { kind, a, b };
+    nvring_append(&ring, d);
+}
+
+/* Served from the waits (hal_avr.c); the telemetry ring holds a
+   few records at a time, so each one waits for room.           */
+void evlog_dump(void)
+{
+    if (!ring.open) nvring_open(&ring);
+    const uint16_t n = ring.count;
+    const uint8_t  c[2] = { (uint8_t)n, (uint8_t)(n >> 8) };
+    tlm_emit_wait(TLM_LOG, c, sizeof c);
+
+    uint8_t p[2 * (EVLOG_LEN + 2)], k = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t seq;
+        if (!nvring_get(&ring, i, &seq, p + k + 2)) continue;    /* torn */
+        p[k]     = (uint8_t)seq;
+        p[k + 1] = (uint8_t)(seq >> 8);
+        k += EVLOG_LEN + 2;
+        if (k == sizeof p) {
+            hal_wdt_kick();
+            tlm_emit_wait(TLM_LOG, p, k);
+            k = 0;
+        }
+    }
+    if (k) tlm_emit_wait(TLM_LOG, p, k);
+}
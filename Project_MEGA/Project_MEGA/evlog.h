@@ -0,0 +1,44 @@
+/*************************************************************
+ * evlog.h  — trip and event log in EEPROM
+ *
+ * Append-only, survives power cuts: one record per trip, fault,
+ * emergency and boot, in an nvring (nvring.h) of EVLOG_SLOTS at
+ * EVLOG_ADDR.  When the ring is full the oldest record goes.
+ *
+ *   kind             a                 b
+ *   LOG_BOOT         reset cause       1 = resumed (persist.h)
+ *   LOG_TRIP         from floor        to floor
+ *   LOG_FAULT        floor             floor asked for (same)
+ *   LOG_EMERGENCY    floor stopped at  target
+ *
+ * Each record carries the ring's sequence number, so gaps show
+ * records lost to a torn write.  'L' on USART0 (teledec -L)
+ * sends the whole log, oldest first: one TLM_LOG record with
+ * the count (torn records included, as seq gaps), then two log
+ * records per TLM_LOG record,
+ * [seq:2 LE][kind][a][b] each, ~0.2 s for a full log.
+ *
+ * Wear: 6 bytes per record, each cell rewritten once per 256
+ * records (Code.md 4.13).
+ *************************************************************/
+#ifndef EVLOG_H
+#define EVLOG_H
+
+#include <stdint.h>
+
+#define EVLOG_ADDR        0xA00
+#define EVLOG_SLOTS       256          /* 6 bytes each, to 0x1000    */
+#define EVLOG_LEN         3
+#define EVLOG_TAG         'L'          /* nvring CRC seed            */
+#define EVLOG_DUMP_CHAR   'L'          /* host → MEGA USART0         */
+
+#define LOG_BOOT          1
+#define LOG_TRIP          2
+#define LOG_FAULT         3
+#define LOG_EMERGENCY     4
+
+void evlog_init(void);                 /* find the newest record     */
+void evlog_add(uint8_t kind, uint8_t a, uint8_t b);
+void evlog_dump(void);                 /* all of it as TLM_LOG       */
+
+#endif /* EVLOG_H */
@@ -0,0 +1,81 @@
+/*************************************************************
+ * hal.h  — hardware abstraction for the elevator controller
+ *
+ * The FSM in elevator.c only talks to the board through these
+ * calls, so it builds unchanged for the ATmega2560 (hal_avr.c)
+ * and for Linux (tools/hal_sim.c: in-memory fakes, simulated
+ * time).  Calls that wait on the outside world — keypad, delays
+ * — block, exactly as on the board; the simulator advances its
+ * clock instead of spinning.
+ *
+ * Telemetry (telemetry.h) is the sixth interface; the simulator
+ * provides its own tlm_emit()/tlm_now().
+ *************************************************************/
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+/* Module state that the host keeps once per simulator thread
+   (tools/sweep); on the board, one plain static               */
+#ifdef __AVR__
+#define HAL_PER_THREAD
+#else
+#define HAL_PER_THREAD  __thread
+#endif
+
+void     hal_init(void);               /* all of the below; IRQs on;
+                                          returns with the LCD up and
+                                          the UNO answering (or
+                                          HAL_UNO_WAIT_MS gone)     */
+#define HAL_UNO_WAIT_MS     2000
+
+/* --- time ----------------------------------------------------------- */
+void     hal_wait_ms(uint16_t ms);     /* 10 ms resolution on AVR    */
+
+/* --- keypad --------------------------------------------------------- */
+char     hal_key_get(void);            /* wait for release + press   */
+
+/* --- LCD (16x2) ----------------------------------------------------- */
+void     hal_lcd_clear(void);
+void     hal_lcd_gotoxy(uint8_t x, uint8_t y);
+void     hal_lcd_putc(char c);
+void     hal_lcd_puts(const char *s);
+
+/* --- SPI link to the UNO (protocol.h) ------------------------------- */
+void     hal_spi_frame(const uint8_t *b, uint8_t n);  /* one SS-low frame */
+uint8_t  hal_spi_reply(uint8_t b);     /* wait the slave's reload,
+                                          send *b*, return its reply */
+
+/* --- RAM ------------------------------------------------------------ */
+void     hal_stack_stats(uint8_t *p);  /* STACK_STATS_LEN bytes,
+                                          protocol.h layout (stack.h) */
+
+/* --- emergency input (latched on the falling edge) ------------------ */
+uint8_t  hal_emg_pending(void);
+uint16_t hal_emg_stamp(void);          /* tlm_now() at the edge      */
+void     hal_emg_clear(void);
+
+/* --- reset and watchdog --------------------------------------------- */
+#define HAL_RESET_POWER     0x01       /* MCUSR bits, as on the MEGA */
+#define HAL_RESET_EXTERNAL  0x02
+#define HAL_RESET_BROWNOUT  0x04
+#define HAL_RESET_WATCHDOG  0x08
+#define HAL_WDT_MS          500        /* no kick for this long: reset */
+
+uint8_t  hal_reset_cause(void);        /* HAL_RESET_* of this boot   */
+void     hal_wdt_kick(void);           /* also done inside the waits */
+
+/* --- EEPROM (4 KiB) ------------------------------------------------- */
+/* 0x000 snapshot ring (persist.h), 0xA00 trip and event log (evlog.h) */
+void     hal_nv_read(uint16_t addr, void *p, uint8_t n);
+                                       /* after hal_nv_flush()      */
+void     hal_nv_update(uint16_t addr, const void *p, uint8_t n);
+                                       /* queued, returns at once;
+                                          written in the background,
+                                          only the bytes that
+                                          differ, ~3.4 ms each      */
+void     hal_nv_flush(void);           /* barrier: returns when all
+                                          queued bytes are written  */
+
+#endif /* HAL_H */
@@ -0,0 +1,265 @@
+/*************************************************************
+ * hal_avr.c  — hal.h on the ATmega2560 (MEGA)
+ *
+ * Emergency button on INT4, 100 Hz tick on Timer-1 (CTC), SPI
+ * master at 1 MHz, keypad on PORTK, HD44780 LCD, watchdog and
+ * EEPROM.
+ *
+ * Boot is one loop over two sequences that are mostly waiting:
+ * the LCD power-up (lcd_init_step: 16 ms, 5 ms, 2 x 64 us, then
+ * the set-up commands) and the UNO handshake (one CMD_STATUS
+ * byte per millisecond until STATUS_READY comes back).  Both are
+ * timed on Timer-1, started first, so the keypad and SPI set-up
+ * and the UNO's own start-up all fit inside the LCD's 16 ms.
+ *
+ * The watchdog runs from hal_init() on.  It is kicked by the main
+ * loop and inside the waits (hal_wait_ms, the keypad loops), so
+ * it only fires when code outside them hangs for HAL_WDT_MS.
+ *
+ * EEPROM writes go through a queue of (address, byte) entries
+ * that ISR(EE_READY_vect) works off, one byte per 3.4 ms write;
+ * a byte the cell already holds is skipped there.  A save costs
+ * the main loop the enqueue only, unless NV_QUEUE_LEN bytes are
+ * already waiting.  Reads wait for the queue to drain first.
+ *************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
+#include <util/delay.h>
+#include "hal.h"
+#include "lcd.h"
+#include "evlog.h"
+#include "keypad.h"
+#include "protocol.h"
+#include "stack.h"
+#include "telemetry.h"
+#include "trace.h"
+
+#define EMG_PIN   PE4          /* D2 — emergency button, active-LOW */
+
+/* Bytes waiting for the EEPROM; the largest burst is a trip's
+   end: snapshot, log record, snapshot = 16 bytes              */
+#define NV_QUEUE_LEN     32                 /* power of two   */
+
+/* Boot timing, in Timer-1 counts (TLM_COUNT_US) */
+#define UNO_POLL_COUNTS  (1000 / TLM_COUNT_US)
+#define UNO_WAIT_COUNTS  ((uint16_t)(HAL_UNO_WAIT_MS * 1000UL / TLM_COUNT_US))
+
+volatile uint32_t tick10ms  = 0;    ///< 100 Hz system tick (Timer-1 CTC)
+static volatile uint8_t  emg_flag  = 0;    ///< set in INT4 ISR when button pressed
+static volatile uint16_t emg_stamp = 0;    ///< tlm_now() at the INT4 edge
+static uint8_t reset_cause __attribute__((section(".noinit")));   ///< MCUSR at reset
+
+static uint16_t         nv_addr[NV_QUEUE_LEN];
+static uint8_t          nv_data[NV_QUEUE_LEN];
+static volatile uint8_t nv_head;           ///< written by main
+static volatile uint8_t nv_tail;           ///< written by EE_READY ISR
+
+/* .init3 runs before .data/.bss are set up.  After a watchdog reset
+   the WDT stays on at its shortest timeout, so turn it off here and
+   keep MCUSR for hal_reset_cause().  A bootloader that clears MCUSR
+   itself leaves 0 (cause unknown).                                */
+void hal_reset_early(void) __attribute__((naked, used, section(".init3")));
+void hal_reset_early(void)
+{
+    reset_cause = MCUSR;
+    MCUSR = 0;
+    wdt_disable();
+}
+
+/* --- EEPROM ready: start the next byte that differs --------------- */
+ISR(EE_READY_vect)
+{
+    uint8_t t = nv_tail;
+    while (t != nv_head) {
+        const uint16_t a = nv_addr[t];
+        const uint8_t  v = nv_data[t];
+        t = (t + 1) & (NV_QUEUE_LEN - 1);
+        EEAR  = a;
+        EECR |= _BV(EERE);                   /* read: 4 cycles halt */
+        if (EEDR != v) {
+            EEDR  = v;
+            EECR |= _BV(EEMPE);              /* EEPE within 4 cycles */
+            EECR |= _BV(EEPE);               /* erase + write        */
+            nv_tail = t;
+            TRACE_ISR(TR_ISR_EE, (uint8_t)a);
+            return;
+        }
+    }
+    nv_tail = t;
+    EECR &= ~_BV(EERIE);                     /* queue empty          */
+}
+
+/* --- external interrupt: emergency push-button -------------------- */
+ISR(INT4_vect) { TRACE_ISR(TR_ISR_EMG, 0); emg_flag = 1; emg_stamp = tlm_now(); }
+
+/* --- time-base interrupt: 10 ms tick ------------------------------ */
+ISR(TIMER1_COMPA_vect)
+{
+    const uint32_t t = tick10ms + 1;
+    tick10ms = t;
+    TRACE_ISR(TR_ISR_TICK, (uint8_t)t);
+}
+
+/* --- SPI master (3-wire, 1 MHz) ----------------------------------- */
+static void spi_master_init(void)
+{
+    DDRB |= _BV(PB0) | _BV(PB1) | _BV(PB2);   /* SS, SCK, MOSI outputs */
+    DDRB &= ~_BV(PB3);                        /* MISO input            */
+    PORTB |= _BV(PB3);                        /* 0xFF while UNO is off */
+    PORTB |= _BV(PB0);                        /* keep SS high (idle)   */
+    SPCR  =  _BV(SPE) | _BV(MSTR) | _BV(SPR0);/* enable, clk/16        */
+}
+
+static inline uint8_t spi_tx(uint8_t data)
+{
+    SPDR = data;
+    while (!(SPSR & _BV(SPIF)));
+    return SPDR;
+}
+
+/* The UNO answers each byte with its status on the next one */
+static uint8_t uno_ready(void)
+{
+    const uint8_t s = hal_spi_reply(CMD_STATUS);
+    return s != 0xFF && (s & STATUS_READY);
+}
+
+void hal_init(void)
+{
+    /* --- 10 ms system tick, and the boot clock -------------------- */
+    TCCR1B = _BV(WGM12) | _BV(CS12) | _BV(CS10);    /* CTC, /1024 clk */
+    OCR1A  = (F_CPU/1024/100) - 1;                  /* 10 ms period   */
+    TIMSK1 = _BV(OCIE1A);
+
+    /* --- emergency button input ----------------------------------- */
+    DDRE  &= ~_BV(EMG_PIN);
+    PORTE |=  _BV(EMG_PIN);                  /* internal pull-up       */
+    EICRB |=  _BV(ISC41);                    /* falling edge           */
+    EIMSK |=  _BV(INT4);
+    sei();
+
+    /* --- peripherals ---------------------------------------------- */
+    KEYPAD_Init();
+    spi_master_init();
+
+    /* --- LCD power-up and UNO handshake, side by side ------------- */
+    uint16_t lcd_at = 0, uno_at = 0, uno_up = 0xFFFF;
+    uint8_t  lcd_busy = 1, uno_busy = 1;
+    while (lcd_busy || uno_busy) {
+        const uint16_t now = tlm_now();
+        if (lcd_busy && (int16_t)(now - lcd_at) >= 0) {
+            const uint16_t us = lcd_init_step(LCD_DISP_ON);
+            lcd_at   = now + us / TLM_COUNT_US + 1;     /* at least us */
+            lcd_busy = us != 0;
+        }
+        if (uno_busy && (int16_t)(now - uno_at) >= 0) {
+            if (uno_ready())               { uno_up = now; uno_busy = 0; }
+            else if (now >= UNO_WAIT_COUNTS) uno_busy = 0;   /* no UNO  */
+            uno_at = now + UNO_POLL_COUNTS;
+        }
+    }
+    const uint8_t p[3] = { TLM_PROBE_UNO_READY, (uint8_t)uno_up, (uint8_t)(uno_up >> 8) };
+    tlm_emit(TLM_TIMING, p, sizeof p);
+
+    wdt_enable(WDTO_500MS);                         /* HAL_WDT_MS     */
+}
+
+/* One command byte from the host on USART0 (teledec -T / -L) */
+static void host_poll(void)
+{
+    if (!(UCSR0A & _BV(RXC0))) return;
+    switch (UDR0) {
+    case TRACE_DUMP_CHAR: trace_dump(); break;
+    case EVLOG_DUMP_CHAR: evlog_dump(); break;
+    }
+}
+
+/* Busy-wait helper that keeps global interrupts enabled */
+void hal_wait_ms(uint16_t ms)
+{
+    const uint32_t target = tick10ms + ms / 10;
+    while (tick10ms < target) {      /* low-power sleep could go here */
+        wdt_reset();
+        host_poll();
+    }
+}
+
+/* Called from every polling loop in keypad.c: a user taking their
+   time is not a hang, and host commands are served meanwhile.     */
+void KEYPAD_Idle(void)
+{
+    wdt_reset();
+    host_poll();
+}
+
+char hal_key_get(void)
+{
+    return KEYPAD_GetKey();
+}
+
+void hal_lcd_clear(void)                     { lcd_clrscr(); }
+void hal_lcd_gotoxy(uint8_t x, uint8_t y)    { lcd_gotoxy(x, y); }
+void hal_lcd_putc(char c)                    { lcd_putc(c); }
+void hal_lcd_puts(const char *s)             { lcd_puts(s); }
+
+/* Opcode + arguments in one SS-low frame (protocol.h) */
+void hal_spi_frame(const uint8_t *b, uint8_t n)
+{
+    TRACE(TR_SPI_BEGIN, b[0]);
+    PORTB &= ~_BV(PB0);                       /* SS low                */
+    for (uint8_t i = 0; i < n; i++) {
+        if (i) _delay_us(20);                 /* slave ISR per byte    */
+        spi_tx(b[i]);
+    }
+    PORTB |=  _BV(PB0);                       /* SS high               */
+    TRACE(TR_SPI_END, 0);
+}
+
+uint8_t hal_spi_reply(uint8_t b)
+{
+    _delay_us(20);                            /* slave ISR reloads SPDR */
+    PORTB &= ~_BV(PB0);
+    const uint8_t r = spi_tx(b);
+    PORTB |=  _BV(PB0);
+    return r;
+}
+
+void     hal_stack_stats(uint8_t *p) { stack_report(p); }
+
+uint8_t  hal_emg_pending(void) { return emg_flag; }
+uint16_t hal_emg_stamp(void)   { return emg_stamp; }
+void     hal_emg_clear(void)   { emg_flag = 0; }
+
+uint8_t  hal_reset_cause(void) { return reset_cause; }
+void     hal_wdt_kick(void)    { wdt_reset(); }
+
+void hal_nv_read(uint16_t addr, void *p, uint8_t n)
+{
+    hal_nv_flush();                          /* see the queued bytes */
+    eeprom_read_block(p, (const void *)(uintptr_t)addr, n);
+}
+
+/* The ISR only runs while EERIE is set, and clears it itself once
+   the queue is empty; setting it after each entry cannot strand one */
+void hal_nv_update(uint16_t addr, const void *p, uint8_t n)
+{
+    const uint8_t *b = p;
+    while (n--) {
+        const uint8_t h = nv_head, next = (h + 1) & (NV_QUEUE_LEN - 1);
+        while (next == nv_tail)              /* full: one byte, 3.4 ms */
+            wdt_reset();
+        nv_addr[h] = addr++;
+        nv_data[h] = *b++;
+        nv_head    = next;
+        EECR |= _BV(EERIE);
+    }
+}
+
+/* At most NV_QUEUE_LEN writes, ~110 ms */
+void hal_nv_flush(void)
+{
+    while (nv_tail != nv_head || (EECR & _BV(EEPE)))
+        wdt_reset();
+}
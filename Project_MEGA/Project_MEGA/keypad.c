@@ -74,6 +74,7 @@ Errors and omissions should be reported to codelibraries@exploreembedded.com
 
 #include "keypad.h"
 #include "delay.h"
+#include "trace.h"
 
 
 
@@ -122,6 +123,7 @@ void KEYPAD_WaitForKeyRelease()
 	{
 		do
 		{
+			KEYPAD_Idle();
 			M_ROW=0x0F;           // Pull the ROW lines to low and Column lines high.
 			key=M_COL & 0x0F;     // Read the Columns, to check the key press
 		}while(key!=0x0F);
@@ -155,6 +157,7 @@ void KEYPAD_WaitForKeyPress()
 	{
 		do
 		{
+			KEYPAD_Idle();
 			M_ROW=0x0F;		  // Pull the ROW lines to low and Column lines high.
 			var_keyPress_u8=M_COL & 0x0F;	  // Read the Columns, to check the key press
 		}while(var_keyPress_u8==0x0F); // Wait till the Key is pressed,
@@ -196,9 +199,11 @@ uint8_t KEYPAD_GetKey()
 	uint8_t var_keyPress_u8;
 
 	KEYPAD_WaitForKeyRelease();    // Wait for the previous key release
+	TRACE(TR_KEY_RELEASED, 0);
 	DELAY_ms(1);
 
 	KEYPAD_WaitForKeyPress();      // Wait for the new key press
+	TRACE(TR_KEY_PRESSED, 0);
 	var_keyPress_u8 = keypad_ScanKey();        // Scan for the key pressed.
 
 	switch(var_keyPress_u8)                       // Decode the key
@@ -221,6 +226,7 @@ uint8_t KEYPAD_GetKey()
 	case 0x7e: var_keyPress_u8='A'; break;  
 	default  : var_keyPress_u8='z'; break;
 	}
+	TRACE(TR_KEY, var_keyPress_u8);
 	return(var_keyPress_u8);                      // Return the key
 }
 
@@ -64,6 +64,10 @@ void KEYPAD_Init();
 void KEYPAD_WaitForKeyRelease();
 void KEYPAD_WaitForKeyPress();
 uint8_t KEYPAD_GetKey();
+
+/* Provided by the board (hal_avr.c): runs on every pass of the wait
+   loops, to kick the watchdog and serve trace dumps */
+void KEYPAD_Idle(void);
 /**************************************************************************************************/
 
 #endif
@@ -27,6 +27,7 @@
 #include <avr/pgmspace.h>
 #include <util/delay.h>
 #include "lcd.h"
+#include "trace.h"
 
 
 
@@ -337,6 +338,7 @@ Returns: none
 *************************************************************************/
 void lcd_command(uint8_t cmd)
 {
+    TRACE(TR_LCD_CMD, cmd);
     lcd_waitbusy();
     lcd_write(cmd,0);
 }
@@ -421,7 +423,7 @@ void lcd_putc(char c)
 {
     uint8_t pos;
 
-
+    TRACE(TR_LCD_CHAR, c);
     pos = lcd_waitbusy();   // read busy-flag and address counter
     if (c=='\n')
     {
@@ -472,6 +474,7 @@ void lcd_puts(const char *s)
     while ( (c = *s++) ) {
         lcd_putc(c);
     }
+    TRACE(TR_LCD_DONE, 0);
 
 }/* lcd_puts */
 
@@ -494,15 +497,18 @@ void lcd_puts_p(const char *progmem_s)
 
 
 /*************************************************************************
-Initialize display and select type of cursor 
-Input:    dispAttr LCD_DISP_OFF            display off
-                   LCD_DISP_ON             display on, cursor off
-                   LCD_DISP_ON_CURSOR      display on, cursor on
-                   LCD_DISP_CURSOR_BLINK   display on, cursor on flashing
-Returns:  none
+One step of the power-up sequence, for callers that have other work to
+do during its waits (hal_init() polls the UNO meanwhile)
+Input:    dispAttr as for lcd_init()
+Returns:  microseconds to wait before the next call, 0 when the display
+          is initialised (the next call starts over)
 *************************************************************************/
-void lcd_init(uint8_t dispAttr)
+uint16_t lcd_init_step(uint8_t dispAttr)
 {
+    static uint8_t step;
+
+    switch (step++) {
+    case 0:
 #if LCD_IO_MODE
     /*
      *  Initialize LCD to 4 bit I/O mode
@@ -536,26 +542,30 @@ void lcd_init(uint8_t dispAttr)
         DDR(LCD_DATA2_PORT) |= _BV(LCD_DATA2_PIN);
         DDR(LCD_DATA3_PORT) |= _BV(LCD_DATA3_PIN);
     }
-    delay(LCD_DELAY_BOOTUP);             /* wait 16ms or more after power-on       */
+    return LCD_DELAY_BOOTUP;             /* wait 16ms or more after power-on       */
     
+    case 1:
     /* initial write to lcd is 8bit */
     LCD_DATA1_PORT |= _BV(LCD_DATA1_PIN);    // LCD_FUNCTION>>4;
     LCD_DATA0_PORT |= _BV(LCD_DATA0_PIN);    // LCD_FUNCTION_8BIT>>4;
     lcd_e_toggle();
-    delay(LCD_DELAY_INIT);               /* delay, busy flag can't be checked here */
+    return LCD_DELAY_INIT;               /* delay, busy flag can't be checked here */
    
+    case 2:
     /* repeat last command */ 
     lcd_e_toggle();      
-    delay(LCD_DELAY_INIT_REP);           /* delay, busy flag can't be checked here */
+    return LCD_DELAY_INIT_REP;           /* delay, busy flag can't be checked here */
     
+    case 3:
     /* repeat last command a third time */
     lcd_e_toggle();      
-    delay(LCD_DELAY_INIT_REP);           /* delay, busy flag can't be checked here */
+    return LCD_DELAY_INIT_REP;           /* delay, busy flag can't be checked here */
 
+    case 4:
     /* now configure for 4bit mode */
     LCD_DATA0_PORT &= ~_BV(LCD_DATA0_PIN);   // LCD_FUNCTION_4BIT_1LINE>>4
     lcd_e_toggle();
-    delay(LCD_DELAY_INIT_4BIT);          /* some displays need this additional delay */
+    return LCD_DELAY_INIT_4BIT;          /* some displays need this additional delay */
     
     /* from now the LCD only accepts 4 bit I/O, we can use lcd_command() */    
 #else
@@ -567,14 +577,18 @@ void lcd_init(uint8_t dispAttr)
     MCUCR = _BV(SRE) | _BV(SRW);
 
     /* reset LCD */
-    delay(LCD_DELAY_BOOTUP);                    /* wait 16ms after power-on     */
+    return LCD_DELAY_BOOTUP;                    /* wait 16ms after power-on     */
+    case 1:
     lcd_write(LCD_FUNCTION_8BIT_1LINE,0);   /* function set: 8bit interface */                   
-    delay(LCD_DELAY_INIT);                      /* wait 5ms                     */
+    return LCD_DELAY_INIT;                      /* wait 5ms                     */
+    case 2:
     lcd_write(LCD_FUNCTION_8BIT_1LINE,0);   /* function set: 8bit interface */                 
-    delay(LCD_DELAY_INIT_REP);                  /* wait 64us                    */
+    return LCD_DELAY_INIT_REP;                  /* wait 64us                    */
+    case 3:
     lcd_write(LCD_FUNCTION_8BIT_1LINE,0);   /* function set: 8bit interface */                
-    delay(LCD_DELAY_INIT_REP);                  /* wait 64us                    */
+    return LCD_DELAY_INIT_REP;                  /* wait 64us                    */
 #endif
+    }
 
 #if KS0073_4LINES_MODE
     /* Display with KS0073 controller requires special commands for enabling 4 line mode */
@@ -589,4 +603,25 @@ void lcd_init(uint8_t dispAttr)
     lcd_command(LCD_MODE_DEFAULT);          /* set entry mode               */
     lcd_command(dispAttr);                  /* display/cursor control       */
 
+    step = 0;
+    return 0;
+}/* lcd_init_step */
+
+
+/*************************************************************************
+Initialize display and select type of cursor 
+Input:    dispAttr LCD_DISP_OFF            display off
+                   LCD_DISP_ON             display on, cursor off
+                   LCD_DISP_ON_CURSOR      display on, cursor on
+                   LCD_DISP_CURSOR_BLINK   display on, cursor on flashing
+Returns:  none
+*************************************************************************/
+void lcd_init(uint8_t dispAttr)
+{
+    uint16_t us;
+
+    while ( (us = lcd_init_step(dispAttr)) != 0 )
+    {
+        while (us--) delay(1);
+    }
 }/* lcd_init */
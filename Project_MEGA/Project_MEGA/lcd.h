@@ -292,6 +292,14 @@
 extern void lcd_init(uint8_t dispAttr);
 
 
+/**
+ @brief    lcd_init() one step at a time, without the waits
+ @param    dispAttr as for lcd_init()
+ @return   microseconds to wait before the next call; 0 when done
+*/
+extern uint16_t lcd_init_step(uint8_t dispAttr);
+
+
 /**
  @brief    Clear display and set cursor to home position
  @return   none
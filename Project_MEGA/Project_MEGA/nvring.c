@@ -0,0 +1,93 @@
+/*************************************************************
+ * nvring.c  — wear-levelled record ring in EEPROM (nvring.h)
+ *************************************************************/
+#include "hal.h"
+#include "nvring.h"
+
+static uint8_t crc8(uint8_t crc, const uint8_t *p, uint8_t n)
+{
+    while (n--) {
+        crc ^= *p++;
+        for (uint8_t i = 0; i < 8; i++)
+            crc = (crc & 0x80) ? (uint8_t)(crc << 1) ^ 0x07 : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static uint16_t slot_addr(const nvring_t *r, uint16_t slot)
+{
+    return r->base + slot * (uint16_t)(r->len + 3);
+}
+
+/* Slot contents if valid: 1, with *seq* and *data* filled in */
+static uint8_t read_slot(const nvring_t *r, uint16_t slot, uint16_t *seq, uint8_t *data)
+{
+    uint8_t b[NVRING_MAX_DATA + 3];
+    hal_nv_read(slot_addr(r, slot), b, r->len + 3);
+    if (crc8(r->tag, b, r->len + 2) != b[r->len + 2]) return 0;
+    *seq = b[0] | b[1] << 8;
+    for (uint8_t i = 0; i < r->len; i++) data[i] = b[2 + i];
+    return 1;
+}
+
+void nvring_open(nvring_t *r)
+{
+    uint8_t  data[NVRING_MAX_DATA];
+    uint16_t seq, newest = 0;
+    uint8_t  any = 0;
+
+    /* The newest is the highest seq; the ring spans less than half
+       the seq space, so serial arithmetic cannot mistake it.      */
+    for (uint16_t s = 0; s < r->slots; s++) {
+        if (!read_slot(r, s, &seq, data)) continue;
+        if (!any || (int16_t)(seq - newest) > 0) {
+            newest  = seq;
+            r->head = s;
+            any     = 1;
+        }
+    }
+    r->count = 0;
+    if (any) {
+        /* Span back to the oldest valid record, not the number of
+           valid slots: a torn slot in between stays a seq gap that
+           nvring_get() reports, and the oldest is not dropped.    */
+        for (uint16_t s = 0; s < r->slots; s++) {
+            if (!read_slot(r, s, &seq, data)) continue;
+            const uint16_t back = newest - seq;
+            if (back < r->slots && back >= r->count) r->count = back + 1;
+        }
+        r->seq = newest;
+    } else {
+        r->head = r->slots - 1;            /* first append: slot 0  */
+        r->seq  = 0xFFFF;                  /* ... with seq 0        */
+    }
+    r->open = 1;
+}
+
+void nvring_append(nvring_t *r, const uint8_t *data)
+{
+    if (!r->open) nvring_open(r);
+
+    uint8_t b[NVRING_MAX_DATA + 3];
+    const uint16_t seq = r->seq + 1;
+    b[0] = (uint8_t)seq;
+    b[1] = (uint8_t)(seq >> 8);
+    for (uint8_t i = 0; i < r->len; i++) b[2 + i] = data[i];
+    b[r->len + 2] = crc8(r->tag, b, r->len + 2);
+
+    const uint16_t slot = (r->head + 1 == r->slots) ? 0 : r->head + 1;
+    hal_nv_update(slot_addr(r, slot), b, r->len + 3);
+    r->head = slot;
+    r->seq  = seq;
+    if (r->count < r->slots) r->count++;
+}
+
+uint8_t nvring_get(nvring_t *r, uint16_t i, uint16_t *seq, uint8_t *data)
+{
+    if (!r->open) nvring_open(r);
+    if (i >= r->count) return 0;
+
+    const uint16_t back = r->count - 1 - i;             /* from newest */
+    const uint16_t slot = (r->head >= back) ? r->head - back : r->head + r->slots - back;
+    return read_slot(r, slot, seq, data) && *seq == (uint16_t)(r->seq - back);
+}
@@ -0,0 +1,54 @@
+/*************************************************************
+ * nvring.h  — wear-levelled record ring in EEPROM
+ *
+ * A ring of fixed-size slots, written in order and never in
+ * place: every append goes to the slot after the newest, so
+ * each cell is rewritten once per *slots* appends.  A slot is
+ *
+ *   [seq:2 LE][data:len][crc:1]
+ *
+ * seq counts appends (mod 65536); the CRC-8 (poly 0x07) covers
+ * seq and data and starts from the ring's tag, so a ring never
+ * accepts another layout's bytes.  Erased cells (0xFF) and a
+ * slot torn by a power cut fail the CRC.
+ *
+ * After a reset nvring_open() reads every slot and takes the
+ * valid one with the highest seq (serial arithmetic) as the
+ * newest; the rest of the ring follows from it.  Appends before
+ * an open do the open first.
+ *
+ * Hardware-independent (hal_nv_*); the state is per simulator
+ * thread on the host (HAL_PER_THREAD).
+ *************************************************************/
+#ifndef NVRING_H
+#define NVRING_H
+
+#include <stdint.h>
+
+#define NVRING_MAX_DATA   8
+
+typedef struct {
+    uint16_t base;                     /* EEPROM address of slot 0  */
+    uint16_t slots;
+    uint8_t  len;                      /* data bytes per record     */
+    uint8_t  tag;                      /* CRC seed, one per layout  */
+
+    /* nvring_open() */
+    uint8_t  open;
+    uint16_t head;                     /* slot of the newest record */
+    uint16_t seq;                      /* its seq                   */
+    uint16_t count;                    /* records from the oldest
+                                          valid one, torn included  */
+} nvring_t;
+
+#define NVRING(base, slots, len, tag)  { (base), (slots), (len), (tag), 0, 0, 0, 0 }
+#define NVRING_BYTES(slots, len)       ((uint16_t)(slots) * ((len) + 3))
+
+void    nvring_open(nvring_t *r);
+void    nvring_append(nvring_t *r, const uint8_t *data);
+
+/* Record *i*, 0 = oldest of r->count.  0 if that slot is not
+   valid (torn, or overwritten since the open): a seq gap.      */
+uint8_t nvring_get(nvring_t *r, uint16_t i, uint16_t *seq, uint8_t *data);
+
+#endif /* NVRING_H */
@@ -0,0 +1,42 @@
+/*************************************************************
+ * persist.c  — controller snapshot in EEPROM (see persist.h)
+ *
+ * Hardware-independent: tools/hal_sim.c keeps the EEPROM in
+ * memory across a simulated reset (tools/elevsim -x).
+ *************************************************************/
+#include "hal.h"
+#include "nvring.h"
+#include "persist.h"
+#include "telemetry.h"
+
+static HAL_PER_THREAD nvring_t ring = NVRING(PERSIST_ADDR, PERSIST_SLOTS, PERSIST_LEN,
+                                              PERSIST_TAG);
+
+void persist_save(const elevator_t *e)
+{
+    const uint8_t s[PERSIST_LEN] = {
+        (uint8_t)(e->current_floor | (e->state & 1) << 7),
+        (uint8_t)(e->target_floor  | (e->state & 2) << 6) };
+    nvring_append(&ring, s);
+}
+
+uint8_t persist_restore(elevator_t *e)
+{
+    uint8_t  s[PERSIST_LEN];
+    uint16_t seq;
+
+    nvring_open(&ring);
+    if (!nvring_get(&ring, ring.count - 1, &seq, s) || (s[0] & 0x7F) > 99 ||
+        (s[1] & 0x7F) > 99)
+        return 0;
+
+    e->current_floor = s[0] & 0x7F;
+    e->target_floor  = s[1] & 0x7F;
+    e->state         = (state_t)(s[0] >> 7 | (s[1] >> 7) << 1);
+    e->booting       = 1;
+
+    const uint8_t p[4] = { hal_reset_cause(), e->current_floor, e->target_floor,
+                           (uint8_t)e->state };
+    tlm_emit(TLM_RESUME, p, sizeof p);
+    return 1;
+}
@@ -0,0 +1,45 @@
+/*************************************************************
+ * record.c  — TLM_INPUT logging around the FSM inputs (record.h)
+ *
+ * Hardware-independent: also linked into tools/elevsim, which
+ * records and replays on Linux.
+ *************************************************************/
+#include "record.h"
+
+#if RECORD_ENABLE
+#include "telemetry.h"
+
+static uint16_t polls;                 /* since the last input      */
+static uint8_t  emg_seen;              /* REC_EMG sent for this latch */
+
+static void rec_input(uint8_t kind, uint8_t value)
+{
+    const uint8_t p[4] = { kind, value, (uint8_t)polls, (uint8_t)(polls >> 8) };
+    tlm_emit_wait(TLM_INPUT, p, sizeof p);
+    polls = 0;
+}
+
+char rec_key_get(void)
+{
+    const char key = hal_key_get();
+    rec_input(REC_KEY, (uint8_t)key);
+    return key;
+}
+
+uint8_t rec_emg_pending(void)
+{
+    const uint8_t emg = hal_emg_pending();
+    polls++;
+    if (emg && !emg_seen) {
+        emg_seen = 1;
+        rec_input(REC_EMG, 0);
+    }
+    return emg;
+}
+
+void rec_emg_clear(void)
+{
+    hal_emg_clear();
+    emg_seen = 0;
+}
+#endif
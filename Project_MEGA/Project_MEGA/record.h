@@ -0,0 +1,49 @@
+/*************************************************************
+ * record.h  — input recording for deterministic replay (MEGA)
+ *
+ * The FSM's behaviour depends only on the keys it reads and on
+ * when it sees the emergency latch.  With RECORD_ENABLE=1 the
+ * FSM reads both through the wrappers below, which log each
+ * input as a TLM_INPUT record (tick10ms in the header) before
+ * returning it:
+ *
+ *   REC_KEY   value = key, as returned by hal_key_get()
+ *   REC_EMG   first hal_emg_pending() that returned 1 since
+ *             the last clear
+ *
+ * Each record carries the number of hal_emg_pending() calls
+ * since the previous input.  The replay (tools/elevsim -r)
+ * raises the emergency on exactly that poll, so it does not
+ * depend on how long the LCD or SPI took on the board.
+ *
+ * TLM_INPUT records wait for room in the telemetry ring rather
+ * than being dropped; a capture that still shows TLM_DROPPED
+ * lost other records and cannot be checked in full.
+ *
+ * With RECORD_ENABLE=0 (default) the wrappers are the HAL calls.
+ *************************************************************/
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdint.h>
+#include "hal.h"
+
+#ifndef RECORD_ENABLE
+#define RECORD_ENABLE   0
+#endif
+
+/* TLM_INPUT payload[0] */
+#define REC_KEY         1
+#define REC_EMG         2
+
+#if RECORD_ENABLE
+char    rec_key_get(void);
+uint8_t rec_emg_pending(void);
+void    rec_emg_clear(void);
+#else
+static inline char    rec_key_get(void)     { return hal_key_get(); }
+static inline uint8_t rec_emg_pending(void) { return hal_emg_pending(); }
+static inline void    rec_emg_clear(void)   { hal_emg_clear(); }
+#endif
+
+#endif /* RECORD_H */
@@ -0,0 +1,130 @@
+/*************************************************************
+ * telemetry.c  — COBS-framed records over USART0 (MEGA)
+ *
+ * tlm_emit() COBS-encodes straight into a 256-byte TX ring and
+ * returns; ISR(USART0_UDRE_vect) drains the ring one byte per
+ * interrupt.  Producers run in main-loop context only.
+ *
+ * Encoding cost: a single pass of ~8 cycles per byte, so a
+ * typical 7-byte record (+2 COBS bytes) is about 100 cycles,
+ * i.e. ~6 us at 16 MHz including the call overhead.
+ *************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "telemetry.h"
+#include "trace.h"
+
+/* 256 bytes so the uint8_t ring indices wrap for free */
+#define TLM_BUF_SIZE   256
+
+/* tick10ms lives in main.c, Timer-1 counts per tick follow its OCR1A */
+extern volatile uint32_t tick10ms;
+#define TLM_COUNTS_PER_TICK  (F_CPU / 1024 / 100)
+
+static uint8_t          tx_buf[TLM_BUF_SIZE];
+static volatile uint8_t tx_head;                /* written by main   */
+static volatile uint8_t tx_tail;                /* written by ISR    */
+static uint16_t         dropped;                /* records lost      */
+
+/* --- USART0 data-register-empty: push one byte ------------------- */
+ISR(USART0_UDRE_vect)
+{
+    uint8_t t = tx_tail;
+    const uint8_t b = tx_buf[t++];
+    UDR0 = b;
+    TRACE_ISR_HF(TR_ISR_UDRE, b);
+    tx_tail = t;
+    if (t == tx_head) {
+        UCSR0B &= ~_BV(UDRIE0);                 /* ring empty        */
+        TRACE_ISR(TR_ISR_UDRE_IDLE, 0);
+    }
+}
+
+void tlm_init(void)
+{
+    UBRR0  = (F_CPU / 8 / TLM_BAUD) - 1;        /* 16 → 117.6 kBd    */
+    UCSR0A = _BV(U2X0);
+    UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);         /* 8N1               */
+    UCSR0B = _BV(TXEN0) | _BV(RXEN0);           /* RX: host commands */
+    tlm_emit(TLM_BOOT, 0, 0);
+}
+
+/** 16-bit fine timestamp in Timer-1 counts (64 us), wraps after 4.2 s. */
+uint16_t tlm_now(void)
+{
+    uint32_t t;
+    uint8_t  c;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t = tick10ms;
+        c = TCNT1;
+        if (TIFR1 & _BV(OCF1A)) {               /* tick ISR pending  */
+            t++;
+            c = TCNT1;
+        }
+    }
+    return (uint16_t)t * TLM_COUNTS_PER_TICK + c;
+}
+
+/** Busy-wait until the ISR has sent everything queued. */
+void tlm_flush(void)
+{
+    while (tx_tail != tx_head) ;
+}
+
+/** As tlm_emit(), but wait for the ISR to make room instead of
+    dropping: at most one full ring, ~22 ms at 115200 Bd.         */
+void tlm_emit_wait(uint8_t type, const uint8_t *payload, uint8_t len)
+{
+    if (len > TLM_MAX_PAYLOAD) len = TLM_MAX_PAYLOAD;
+    /* room for this record and a TLM_DROPPED report ahead of it */
+    const uint8_t need = 2 * TLM_HEADER_LEN + len + 2 + 4;
+    while ((uint8_t)(tx_tail - tx_head - 1) < need) ;
+    tlm_emit(type, payload, len);
+}
+
+/** Queue one record.  Dropped (and counted) if the ring lacks room. */
+void tlm_emit(uint8_t type, const uint8_t *payload, uint8_t len)
+{
+    if (len > TLM_MAX_PAYLOAD) len = TLM_MAX_PAYLOAD;
+
+    if (dropped) {                              /* report losses first */
+        const uint16_t lost = dropped;
+        const uint8_t  p[2] = { (uint8_t)lost, (uint8_t)(lost >> 8) };
+        dropped = 0;
+        tlm_emit(TLM_DROPPED, p, 2);
+        if (dropped) { dropped = lost + 1; return; }
+    }
+
+    /* COBS adds one code byte, plus the 0x00 frame delimiter */
+    const uint8_t free_space = tx_tail - tx_head - 1;
+    if (free_space < TLM_HEADER_LEN + len + 2) { dropped++; return; }
+
+    uint32_t t;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { t = tick10ms; }
+
+    /* Encode in place: *at* holds the pending COBS code byte */
+    uint8_t h    = tx_head;
+    uint8_t at   = h++;
+    uint8_t code = 1;
+#define COBS_PUT(v) do {                                         \
+        const uint8_t b_ = (v);                                   \
+        if (b_) { tx_buf[h] = b_; code++; }                       \
+        else    { tx_buf[at] = code; at = h; code = 1; }          \
+        h++;                                                      \
+    } while (0)
+
+    COBS_PUT(type);
+    COBS_PUT((uint8_t)t);
+    COBS_PUT((uint8_t)(t >> 8));
+    COBS_PUT((uint8_t)(t >> 16));
+    COBS_PUT((uint8_t)(t >> 24));
+    while (len--) COBS_PUT(*payload++);
+#undef COBS_PUT
+
+    tx_buf[at] = code;
+    tx_buf[h++] = 0x00;                         /* frame delimiter   */
+    tx_head = h;
+
+    UCSR0B |= _BV(UDRIE0);                      /* kick the drain    */
+}
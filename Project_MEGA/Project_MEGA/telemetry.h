@@ -0,0 +1,87 @@
+/*************************************************************
+ * telemetry.h  — binary trace stream (MEGA → host, USART0)
+ *
+ * Every record is
+ *
+ *     [type:1][tick:4, little-endian tick10ms][payload:0..8]
+ *
+ * COBS-encoded and terminated by a single 0x00 byte, so the
+ * host can resynchronise on any delimiter.  This header is also
+ * compiled into the Linux decoder (tools/teledec.c) and must
+ * therefore only depend on <stdint.h>.
+ *************************************************************/
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#define TLM_BAUD            115200UL   /* USART0, 8N1, U2X        */
+#define TLM_HEADER_LEN      5          /* type + 32-bit timestamp */
+#define TLM_MAX_PAYLOAD     12
+
+/* Record types ------------------------------------------------------ */
+#define TLM_BOOT       0x01   /* -                                    */
+#define TLM_STATE      0x02   /* from, to            (state_t)        */
+#define TLM_FLOOR      0x03   /* current, target                      */
+#define TLM_KEY        0x04   /* ASCII key                            */
+#define TLM_SPI        0x05   /* opcode sent to the UNO               */
+#define TLM_TIMING     0x06   /* probe, u16 elapsed (Timer-1 counts)  */
+#define TLM_POWER      0x07   /* UNO u32 uptime, u32 asleep (64 us
+                                 counts), u32 wakeups; per trip       */
+#define TLM_TRACE      0x08   /* 0..3 × [id, v, u16 Timer-1 count]
+                                 from a trace dump (trace.h)          */
+#define TLM_STACK      0x09   /* board (TLM_BOARD_*), u16 static,
+                                 u16 unused since reset, u16 gap now;
+                                 per trip (stack.h)                   */
+#define TLM_INPUT      0x0A   /* kind (REC_*), value, u16 emergency
+                                 polls since the previous input;
+                                 never dropped (record.h)             */
+#define TLM_RESUME     0x0B   /* reset cause (HAL_RESET_*), floor,
+                                 target, state: warm restart from the
+                                 EEPROM snapshot (persist.h)          */
+#define TLM_LOG        0x0C   /* u16 count, then 1..2 × [seq:2][kind]
+                                 [a][b]: an 'L' dump (evlog.h)        */
+#define TLM_DROPPED    0x7F   /* u16 records lost to a full buffer    */
+
+/* TLM_STACK payload[0] */
+#define TLM_BOARD_MEGA 0
+#define TLM_BOARD_UNO  1
+
+/* Timing probes (TLM_TIMING payload[0]) ----------------------------- */
+#define TLM_PROBE_FLOOR_LCD   0x01   /* "Floor xx" sprintf + redraw   */
+#define TLM_PROBE_PROMPT_LCD  0x02   /* clear + "Choose floor:"       */
+#define TLM_PROBE_EMG_REACT   0x03   /* INT4 edge → FSM leaves MOVING */
+#define TLM_PROBE_UNO_READY   0x04   /* reset → UNO answers STATUS_READY;
+                                        0xFFFF = gave up (hal.h)     */
+#define TLM_PROBE_BOOT        0x05   /* reset → first "Choose floor:" */
+
+/* One Timer-1 count = 1024 / F_CPU = 64 us at 16 MHz                  */
+#define TLM_COUNT_US          64
+
+void     tlm_init(void);
+void     tlm_emit(uint8_t type, const uint8_t *payload, uint8_t len);
+uint16_t tlm_now(void);
+void     tlm_flush(void);              /* wait until all is sent    */
+void     tlm_emit_wait(uint8_t type, const uint8_t *payload, uint8_t len);
+                                       /* wait for room, never drop */
+
+static inline void tlm_emit2(uint8_t type, uint8_t a, uint8_t b)
+{
+    const uint8_t p[2] = { a, b };
+    tlm_emit(type, p, 2);
+}
+
+static inline void tlm_state(uint8_t from, uint8_t to) { tlm_emit2(TLM_STATE, from, to); }
+static inline void tlm_floor(uint8_t cur, uint8_t tgt) { tlm_emit2(TLM_FLOOR, cur, tgt); }
+static inline void tlm_key  (uint8_t key)  { tlm_emit(TLM_KEY, &key, 1); }
+static inline void tlm_spi  (uint8_t op)   { tlm_emit(TLM_SPI, &op, 1);  }
+
+/** Report the time elapsed since *since* (a tlm_now() stamp). */
+static inline void tlm_timing(uint8_t probe, uint16_t since)
+{
+    const uint16_t dt = tlm_now() - since;
+    const uint8_t p[3] = { probe, (uint8_t)dt, (uint8_t)(dt >> 8) };
+    tlm_emit(TLM_TIMING, p, 3);
+}
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,70 @@
+/*************************************************************
+ * trace.c  — trace ring and its dump (MEGA)
+ *
+ * 'T' on USART0 asks for a dump.  hal_avr.c reads the host's
+ * commands in its waits, so a request is served within one key
+ * scan or one 10 ms tick.  The dump forwards CMD_TRACE_DUMP to
+ * the UNO, which sends its own ring on its USB port, then emits
+ * this ring as TLM_TRACE records.  The ring is read in place,
+ * oldest first; the ISRs add entries far slower than the dump
+ * reads them.
+ *************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "trace.h"
+
+#if TRACE_ENABLE == 1
+#include "hal.h"
+#include "protocol.h"
+#include "telemetry.h"
+
+trace_ev_t trace_buf[TRACE_DEPTH];
+uint8_t    trace_head;
+
+void trace_init(void)
+{
+    /* nothing: tlm_init() set up USART0 both ways */
+}
+
+void trace_dump(void)
+{
+    TRACE(TR_DUMP, 0);
+    const uint8_t cmd = CMD_TRACE_DUMP;         /* the UNO's ring    */
+    hal_spi_frame(&cmd, 1);
+
+    uint8_t head;
+    cli();
+    head = trace_head;
+    sei();
+
+    /* 256 entries do not fit the telemetry ring at once: let each
+       record drain before queueing the next.                      */
+    tlm_flush();
+    tlm_emit(TLM_TRACE, 0, 0);
+    uint8_t p[TLM_MAX_PAYLOAD], n = 0;
+    uint8_t i = head;
+    do {
+        cli();
+        const trace_ev_t e = trace_buf[i];
+        sei();
+        if (!e.id) continue;                    /* never written     */
+        p[n++] = e.id;
+        p[n++] = e.v;
+        p[n++] = e.t;
+        if (n == TLM_MAX_PAYLOAD) {
+            tlm_flush();
+            tlm_emit(TLM_TRACE, p, n);
+            n = 0;
+        }
+    } while (++i != head);
+    if (n) tlm_emit(TLM_TRACE, p, n);
+}
+
+#elif TRACE_ENABLE == 2
+
+void trace_init(void)
+{
+    TRACE_DDR |= _BV(TRACE_PIN);
+}
+
+#endif
@@ -0,0 +1,153 @@
+/*************************************************************
+ * trace.h  — compile-time trace points (MEGA and UNO)
+ *
+ * TRACE(id, v) stores an event id, one byte of data and the low
+ * byte of the Timer-1 count (64 us) in a RAM ring.  A dump request sends the
+ * ring as TLM_TRACE records over the board's USART (Code.md 4.3);
+ * tools/teledec prints them with their time deltas.
+ *
+ * Build options (project symbols or -D):
+ *   TRACE_ENABLE     0 = off: trace points compile to nothing
+ *                    1 = RAM ring of 256 entries (768 B)
+ *                    2 = toggle TRACE_PIN instead, for a scope or
+ *                        logic analyser (no ring, no dump)
+ *   TRACE_HIGH_RATE  1 = also trace the ISRs that run at 1 kHz and
+ *                    more (Timer-0 LEDs, Timer-2 synth, one USART
+ *                    byte), which otherwise flush the ring in ms
+ *
+ * Cost of one point (-Os): about 20 cycles in the ring from an
+ * ISR and about 23 from main-loop code (SREG save + CLI +
+ * restore), counted from the instructions; tools/bench
+ * (trace_points.c) measures them.  2 cycles (SBI on PINx) for
+ * the pin.
+ *
+ * Both projects carry the same copy; tools/teledec.c includes
+ * it too, so with TRACE_ENABLE=0 it needs only <stdint.h>.
+ *************************************************************/
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE      0
+#endif
+#ifndef TRACE_HIGH_RATE
+#define TRACE_HIGH_RATE   0
+#endif
+
+/* Event ids; 0 marks an unused ring slot ----------------------------- */
+/* MEGA                                        v                        */
+#define TR_FSM_STATE      0x01   /* state entered (state_t)             */
+#define TR_SPI_BEGIN      0x02   /* opcode, SS low                      */
+#define TR_SPI_END        0x03   /* -, SS high                          */
+#define TR_LCD_CMD        0x04   /* HD44780 instruction                 */
+#define TR_LCD_CHAR       0x05   /* character                           */
+#define TR_LCD_DONE       0x06   /* -, lcd_puts() finished              */
+#define TR_KEY_RELEASED   0x07   /* -, previous key let go              */
+#define TR_KEY_PRESSED    0x08   /* -, press debounced                  */
+#define TR_KEY            0x09   /* decoded ASCII key                   */
+#define TR_ISR_TICK       0x10   /* tick10ms low byte (TIMER1_COMPA)    */
+#define TR_ISR_EMG        0x11   /* -, INT4                             */
+#define TR_ISR_UDRE       0x12   /* byte sent (USART0_UDRE, high rate)  */
+#define TR_ISR_UDRE_IDLE  0x13   /* -, telemetry ring drained           */
+#define TR_ISR_EE         0x14   /* address low byte, write started     */
+#define TR_DUMP           0x3F   /* -, dump requested                   */
+/* UNO                                                                  */
+#define TR_ISR_SPI        0x80   /* byte received (SPI_STC)             */
+#define TR_ISR_SEQ        0x81   /* channel (TIMER1_COMPA / COMPB)      */
+#define TR_ISR_EPOCH      0x82   /* -, TIMER1_OVF: Timer-1 wrapped      */
+#define TR_ISR_LED_OVF    0x83   /* -, TIMER0_OVF (high rate)           */
+#define TR_ISR_LED_CMP    0x84   /* LED index (TIMER0_COMPA/B, high rate) */
+#define TR_ISR_SYNTH      0x85   /* -, TIMER2_OVF (high rate)           */
+#define TR_UNO_DUMP       0xBF   /* -, dump requested                   */
+
+/* Dump: one TLM_TRACE record with no entries marks the start, then
+   up to 4 entries of [id][v][t] per record, oldest first.         */
+#define TRACE_RECORD      0x08   /* = TLM_TRACE (telemetry.h)           */
+#define TRACE_DUMP_CHAR   'T'    /* host → MEGA USART0: dump both rings */
+#define TRACE_BAUD        115200UL
+
+/* Timer-1 wraps every 156 counts (10 ms CTC) on the MEGA, marked
+   by TR_ISR_TICK.  On the UNO it free-runs, so its low byte wraps
+   every 256 counts (16.4 ms), unmarked.                           */
+#define TRACE_MEGA_PERIOD 156
+#define TRACE_UNO_PERIOD  256
+
+typedef struct {
+    uint8_t  id;
+    uint8_t  v;
+    uint8_t  t;                        /* TCNT1L                    */
+} trace_ev_t;
+
+#if TRACE_ENABLE == 1
+#include <avr/io.h>
+
+#define TRACE_DEPTH       256          /* trace_head wraps by itself */
+
+extern trace_ev_t trace_buf[TRACE_DEPTH];
+extern uint8_t    trace_head;
+
+/* One writer at a time: ISRs do not nest, so TRACE_ISR() needs no
+   guard; TRACE() shuts the ISRs out of the main loop's point.     */
+static inline void trace_put(uint8_t id, uint8_t v)
+{
+    const uint8_t i = trace_head;
+    trace_ev_t *const e = &trace_buf[i];
+    e->id = id;
+    e->v  = v;
+    e->t  = TCNT1L;
+    trace_head = i + 1;
+}
+
+#define TRACE_ISR(id, v)  trace_put((id), (v))
+#define TRACE(id, v)      do { const uint8_t sreg_ = SREG; __asm__ __volatile__ ("cli" ::: "memory"); \
+                               trace_put((id), (v)); SREG = sreg_; } while (0)
+
+#elif TRACE_ENABLE == 2
+#include <avr/io.h>
+
+#if defined(__AVR_ATmega2560__)
+#define TRACE_PIN_REG     PINF         /* PF0 = A0                  */
+#define TRACE_DDR         DDRF
+#define TRACE_PIN         PF0
+#else
+#define TRACE_PIN_REG     PIND         /* PD7 = D7                  */
+#define TRACE_DDR         DDRD
+#define TRACE_PIN         PD7
+#endif
+
+/* Writing 1 to PINx toggles the output                             */
+#define TRACE_ISR(id, v)  (TRACE_PIN_REG = _BV(TRACE_PIN))
+#define TRACE(id, v)      (TRACE_PIN_REG = _BV(TRACE_PIN))
+
+#else
+#define TRACE_ISR(id, v)  ((void)0)
+#define TRACE(id, v)      ((void)0)
+#endif
+
+#if TRACE_HIGH_RATE
+#define TRACE_ISR_HF(id, v)  TRACE_ISR(id, v)
+#else
+#define TRACE_ISR_HF(id, v)  ((void)0)
+#endif
+
+/* trace.c (per board) ------------------------------------------------ */
+#if TRACE_ENABLE
+void    trace_init(void);              /* USART RX/TX or the pin    */
+#else
+static inline void trace_init(void) { }
+#endif
+
+#if TRACE_ENABLE == 1
+void    trace_dump(void);              /* send the ring; main loop;
+                                          MEGA: on 'T' (hal_avr.c)  */
+void    trace_request_dump(void);      /* UNO: from the SPI ISR     */
+uint8_t trace_dump_due(void);          /* UNO: main loop has a dump */
+#else
+static inline void    trace_dump(void)         { }
+static inline void    trace_request_dump(void) { }
+static inline uint8_t trace_dump_due(void)     { return 0; }
+#endif
+
+#endif /* TRACE_H */
@@ -0,0 +1,126 @@
+/*************************************************************
+ * audio.c  — priority arbiter on top of the sequencer (UNO)
+ *************************************************************/
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "audio.h"
+#include "sequencer.h"
+#include "melodies.h"   /* generated by tools/rtttl2c */
+
+#if AUDIO_PROFILE
+#define MARK_ON()    (PORTD |=  _BV(PD4))
+#define MARK_OFF()   (PORTD &= ~_BV(PD4))
+#else
+#define MARK_ON()    ((void)0)
+#define MARK_OFF()   ((void)0)
+#endif
+
+typedef struct {
+    const seq_note_t *melody;          /* PROGMEM                   */
+    uint8_t           ch;              /* sequencer channel         */
+    uint8_t           prio;            /* higher pre-empts lower    */
+    uint8_t           policy;          /* AUDIO_QUEUE / AUDIO_DROP  */
+} audio_sound_t;
+
+/* A ding that cannot play at once is stale (the car has moved on);
+   a second emergency request replays the melody once it ends.    */
+static const audio_sound_t sounds[SND_COUNT] PROGMEM = {
+    [SND_NONE]      = { 0,                0,             0, AUDIO_DROP  },
+    [SND_DING]      = { melody_ding,      SEQ_CH_CHIME,  1, AUDIO_DROP  },
+    [SND_EMERGENCY] = { melody_emergency, SEQ_CH_MELODY, 2, AUDIO_QUEUE },
+};
+
+static volatile uint8_t current;       /* sound_t in progress       */
+static volatile uint8_t pending;       /* bit per queued sound_t    */
+
+static inline uint8_t prio_of(uint8_t s)
+{
+    return pgm_read_byte(&sounds[s].prio);
+}
+
+/* The current sound, or SND_NONE once its melody has ended. */
+static uint8_t playing(void)
+{
+    if (current != SND_NONE && !seq_busy(pgm_read_byte(&sounds[current].ch)))
+        current = SND_NONE;
+    return current;
+}
+
+/* Silence every other channel and start *s*; a pre-empted sound is
+   discarded, a synth voice fades out over its release time.       */
+static void start(uint8_t s)
+{
+    const uint8_t ch = pgm_read_byte(&sounds[s].ch);
+
+    for (uint8_t c = 0; c < SEQ_CHANNELS; c++)
+        if (c != ch) seq_stop(c);
+    current = s;
+    seq_play(ch, pgm_read_ptr(&sounds[s].melody));
+}
+
+void audio_init(void)
+{
+#if AUDIO_PROFILE
+    DDRD  |= _BV(PD4);
+    PORTD &= ~_BV(PD4);
+#endif
+    seq_init();
+}
+
+/** Start, queue or drop *snd* according to its priority and policy. */
+void audio_request(sound_t snd)
+{
+    if (snd == SND_NONE || snd >= SND_COUNT) return;
+
+    MARK_ON();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (prio_of(snd) > prio_of(playing()))
+            start(snd);
+        else if (pgm_read_byte(&sounds[snd].policy) == AUDIO_QUEUE)
+            pending |= _BV(snd);
+    }
+    MARK_OFF();
+}
+
+void audio_stop(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        pending = 0;
+        current = SND_NONE;
+        for (uint8_t c = 0; c < SEQ_CHANNELS; c++) seq_stop(c);
+    }
+}
+
+/** Start the highest-priority queued sound once nothing is playing. */
+void audio_poll(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (pending && playing() == SND_NONE) {
+            uint8_t best = SND_NONE;
+            for (uint8_t s = SND_NONE + 1; s < SND_COUNT; s++)
+                if ((pending & _BV(s)) && prio_of(s) > prio_of(best)) best = s;
+            pending &= ~_BV(best);
+            start(best);
+        }
+    }
+}
+
+uint8_t audio_poll_due(void)
+{
+    uint8_t due;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        due = pending && playing() == SND_NONE;
+    }
+    return due;
+}
+
+uint8_t audio_busy(void)
+{
+    return playing() != SND_NONE;
+}
+
+uint8_t audio_pending(void)
+{
+    return pending != 0;
+}
@@ -0,0 +1,44 @@
+/*************************************************************
+ * audio.h  — sound-request arbiter (UNO)
+ *
+ * Every sound has a priority and a policy.  A request that
+ * outranks the sound in progress pre-empts it immediately, from
+ * the SPI interrupt, so the first tone edge follows the command
+ * by at most one Timer-2 period (see Code.md 3.5).  A request
+ * that does not outrank it is queued until the channel is free
+ * (AUDIO_QUEUE) or discarded (AUDIO_DROP).
+ *
+ * Build options (project symbols or -D):
+ *   AUDIO_PROFILE   1 = raise PD4 (D4) from the start of a request
+ *                   until the new sound is running, for a scope
+ *************************************************************/
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdint.h>
+
+#ifndef AUDIO_PROFILE
+#define AUDIO_PROFILE     0
+#endif
+
+/* Sound ids; the priorities live in the table in audio.c         */
+typedef enum {
+    SND_NONE,
+    SND_DING,                          /* arrival / door chime      */
+    SND_EMERGENCY,                     /* emergency melody          */
+    SND_COUNT
+} sound_t;
+
+/* What happens to a request that does not outrank the current one */
+#define AUDIO_QUEUE       0            /* play once the channel is free */
+#define AUDIO_DROP        1            /* discard                   */
+
+void    audio_init(void);              /* also starts the sequencer */
+void    audio_request(sound_t snd);    /* ISR-safe                  */
+void    audio_stop(void);              /* cancel current + queue    */
+void    audio_poll(void);              /* main loop: start queued   */
+uint8_t audio_poll_due(void);          /* audio_poll() has work     */
+uint8_t audio_busy(void);
+uint8_t audio_pending(void);
+
+#endif /* AUDIO_H */
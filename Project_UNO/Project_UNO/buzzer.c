@@ -0,0 +1,39 @@
+/*************************************************************
+ * buzzer.c  — Timer-2 tone generator on OC2B (UNO)
+ *************************************************************/
+#include <avr/io.h>
+#include "buzzer.h"
+
+#define BUZZER_PIN   PD3                /* D3 = OC2B                 */
+#define TONE_CS      (_BV(CS22) | _BV(CS21))               /* clk/256 */
+
+static uint8_t buzzer_volume = 255;     ///< 0..255 → 0..50 % duty
+
+void buzzer_init(void)
+{
+    DDRD  |= _BV(BUZZER_PIN);           /* PD3 → output                */
+    PORTD &= ~_BV(BUZZER_PIN);          /* idle level when disconnected*/
+    TCCR2A = _BV(WGM21) | _BV(WGM20);   /* fast PWM, OC2B disconnected */
+    TCCR2B = _BV(WGM22);                /* TOP = OCR2A, clock stopped  */
+}
+
+/** Set the duty-cycle volume for following notes (255 = 50 %). */
+void buzzer_set_volume(uint8_t vol)
+{
+    buzzer_volume = vol;
+}
+
+void tone_start(uint8_t top)
+{
+    OCR2A  = top;
+    OCR2B  = ((uint16_t)(top + 1) * buzzer_volume) >> 9;
+    TCNT2  = top;                       /* wrap → OC2B set on 1st tick */
+    TCCR2A |= _BV(COM2B1);              /* non-inverting PWM on OC2B   */
+    TCCR2B  = _BV(WGM22) | TONE_CS;     /* start clock                 */
+}
+
+void tone_stop(void)
+{
+    TCCR2B  = _BV(WGM22);               /* stop clock                  */
+    TCCR2A &= ~_BV(COM2B1);             /* pin back to PORTD (low)     */
+}
@@ -0,0 +1,26 @@
+/*************************************************************
+ * buzzer.h  — piezo on PD3 / OC2B, Timer-2 fast PWM (UNO)
+ *
+ * Mode 7: TOP = OCR2A sets the pitch, OCR2B sets the duty cycle
+ * and hence the loudness.  The pin is driven by the compare unit,
+ * so the CPU does no work while a note sounds.  tone_start()
+ * preloads TCNT2 = TOP, so the first rising edge comes on the
+ * next timer tick (16 us) instead of one tone period later.
+ *************************************************************/
+#ifndef BUZZER_H
+#define BUZZER_H
+
+#include <stdint.h>
+
+#define TONE_PRESCALER   256           /* clk/256 → 245 Hz..31 kHz  */
+
+/** OCR2A value for *hz*, rounded; evaluated by the compiler.
+    F_CPU is a project symbol (Project_UNO.cproj, -D).          */
+#define TONE_TOP(hz)     (((F_CPU / TONE_PRESCALER) + (hz) / 2) / (hz) - 1)
+
+void buzzer_init(void);
+void buzzer_set_volume(uint8_t vol);   /* 0..255 → 0..50 % duty     */
+void tone_start(uint8_t top);
+void tone_stop(void);
+
+#endif /* BUZZER_H */
@@ -0,0 +1,287 @@
+/*************************************************************
+ * led.c  — Timer-0 software PWM, gamma table, fade engine (UNO)
+ *************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "led.h"
+#include "trace.h"
+
+#define LED_TICK_DIV  2                /* periods between fade steps */
+
+static const uint8_t led_bit[LED_COUNT] = { _BV(MOV_LED_PIN), _BV(DOOR_LED_PIN) };
+
+/* duty = round(255 * (level/255)^2.2) */
+static const uint8_t led_gamma[256] PROGMEM = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+
+typedef struct {
+    uint16_t level;                    /* 8.8 perceived brightness  */
+    int16_t  step;                     /* per fade step, 0 = steady */
+    uint8_t  target;
+} led_t;
+
+static led_t             led[LED_COUNT];
+static volatile uint8_t  duty[LED_COUNT];    /* next OCR0A/OCR0B   */
+static volatile uint8_t  on_mask;            /* LEDs with duty > 0 */
+static uint8_t           tick_div = LED_TICK_DIV;
+static uint8_t           tick_led;
+
+/* Blink patterns, counted in PWM periods by the overflow ISR     */
+typedef struct {
+    uint16_t half;                     /* periods per on/off phase  */
+    uint16_t left;                     /* periods left in the phase */
+    uint16_t edges;                    /* phase ends still to come  */
+} blink_t;
+
+static blink_t           blink[LED_COUNT];
+static volatile uint8_t  blink_mask;
+
+/* Fade requests from the SPI ISR, armed by led_poll() */
+static volatile uint8_t  req_mask;
+static uint8_t           req_level[LED_COUNT];
+static uint8_t           req_time [LED_COUNT];
+
+/* --- PWM engine -------------------------------------------------- */
+static inline uint8_t engine_on(void)
+{
+    return TIMSK0 != 0;
+}
+
+/* Run Timer-0 only while some LED is dimmed or fading; otherwise
+   leave the pins static.  IRQs must be disabled.                  */
+static void engine_update(void)
+{
+    uint8_t needed = 0;
+    for (uint8_t i = 0; i < LED_COUNT; i++)
+        if (led[i].step || (duty[i] != 0 && duty[i] != 255)) needed = 1;
+    if (blink_mask) needed = 1;
+
+    if (needed && !engine_on()) {
+        OCR0A  = duty[0];
+        OCR0B  = duty[1];
+        TCNT0  = 0;
+        TCCR0A = 0;                          /* normal mode        */
+        TCCR0B = _BV(CS01) | _BV(CS00);      /* clk/64             */
+        TIFR0  = _BV(TOV0) | _BV(OCF0A) | _BV(OCF0B);
+        TIMSK0 = _BV(TOIE0) | _BV(OCIE0A) | _BV(OCIE0B);
+    } else if (!needed && engine_on()) {
+        TIMSK0 = 0;
+        TCCR0B = 0;
+    }
+    if (!needed) {                           /* steady: plain pins */
+        for (uint8_t i = 0; i < LED_COUNT; i++) {
+            if (duty[i]) PORTB |=  led_bit[i];
+            else         PORTB &= ~led_bit[i];
+        }
+    }
+}
+
+static inline void set_duty(uint8_t i, uint8_t d)
+{
+    duty[i] = d;
+    if (d) on_mask |=  led_bit[i];
+    else   on_mask &= ~led_bit[i];
+}
+
+/* One fade step for LED *i*; stops the engine when nothing moves. */
+static inline void fade_step(uint8_t i)
+{
+    led_t *l = &led[i];
+    if (!l->step) return;
+
+    const uint16_t goal = (uint16_t)l->target << 8;
+    const uint16_t next = l->level + l->step;
+    const uint8_t  done = (l->step > 0) ? (next >= goal || next < l->level)
+                                        : (next <= goal || next > l->level);
+    l->level = done ? goal : next;
+    if (done) l->step = 0;
+    set_duty(i, pgm_read_byte(&led_gamma[l->level >> 8]));
+    if (done) engine_update();
+}
+
+/* Advance the blink pattern of LED *i* by one period. */
+static inline void blink_step(uint8_t i)
+{
+    blink_t *b = &blink[i];
+    if (--b->left) return;
+
+    if (!--b->edges) {                       /* last off phase over */
+        blink_mask &= ~_BV(i);
+        engine_update();
+        return;
+    }
+    b->left = b->half;
+    set_duty(i, (b->edges & 1) ? 0 : 255);   /* odd = off phase     */
+}
+
+/* Start of period: switch on every LED whose off-time is still
+   ahead.  If this ISR was held up past a compare match (whose
+   higher-priority ISR then already ran), the LED stays off for
+   this period instead of flashing fully on.                       */
+ISR(TIMER0_OVF_vect)
+{
+    TRACE_ISR_HF(TR_ISR_LED_OVF, 0);
+    uint8_t on = on_mask;
+    const uint8_t t = TCNT0;
+    if (t >= OCR0A) on &= ~_BV(MOV_LED_PIN);
+    if (t >= OCR0B) on &= ~_BV(DOOR_LED_PIN);
+    PORTB |= on;
+
+    if (blink_mask) {
+        for (uint8_t i = 0; i < LED_COUNT; i++)
+            if (blink_mask & _BV(i)) blink_step(i);
+    }
+
+    if (!--tick_div) {
+        tick_div = LED_TICK_DIV;
+        fade_step(tick_led);
+        tick_led ^= 1;
+    }
+}
+
+/* End of on-time; the new duty takes effect from the next period */
+ISR(TIMER0_COMPA_vect)
+{
+    TRACE_ISR_HF(TR_ISR_LED_CMP, 0);
+    PORTB &= ~_BV(MOV_LED_PIN);
+    OCR0A  = duty[0];
+}
+
+ISR(TIMER0_COMPB_vect)
+{
+    TRACE_ISR_HF(TR_ISR_LED_CMP, 1);
+    PORTB &= ~_BV(DOOR_LED_PIN);
+    OCR0B  = duty[1];
+}
+
+/* --- API --------------------------------------------------------- */
+void led_init(void)
+{
+    DDRB  |=  _BV(MOV_LED_PIN) | _BV(DOOR_LED_PIN);
+    PORTB &= ~(_BV(MOV_LED_PIN) | _BV(DOOR_LED_PIN));
+}
+
+/** Jump the LEDs in *mask* to *level*, cancelling any fade or
+    blink pattern. */
+void led_set(uint8_t mask, uint8_t level)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < LED_COUNT; i++) {
+            if (!(mask & _BV(i))) continue;
+            req_mask    &= ~_BV(i);
+            blink_mask  &= ~_BV(i);
+            led[i].level  = (uint16_t)level << 8;
+            led[i].target = level;
+            led[i].step   = 0;
+            set_duty(i, pgm_read_byte(&led_gamma[level]));
+        }
+        engine_update();
+    }
+}
+
+/** Fade the LEDs in *mask* to *level* over *time10ms* × 10 ms.  The
+    division happens in led_poll(), outside the SPI interrupt.     */
+void led_fade(uint8_t mask, uint8_t level, uint8_t time10ms)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < LED_COUNT; i++) {
+            if (!(mask & _BV(i))) continue;
+            req_level[i] = level;
+            req_time [i] = time10ms;
+            req_mask    |= _BV(i);
+        }
+    }
+}
+
+/** Blink the LEDs in *mask* *count* times, *period10ms* × 10 ms per
+    on/off cycle, then leave them off.  Cancels any fade.  The
+    period converts to PWM periods without a division: 5000/1024 is
+    exactly 625/128.                                              */
+void led_blink(uint8_t mask, uint8_t count, uint8_t period10ms)
+{
+    if (!count || !period10ms) { led_set(mask, 0); return; }
+
+    uint16_t half = ((uint32_t)period10ms * 625) >> 7;
+    if (!half) half = 1;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < LED_COUNT; i++) {
+            if (!(mask & _BV(i))) continue;
+            req_mask      &= ~_BV(i);
+            led[i].level   = 0;
+            led[i].target  = 0;
+            led[i].step    = 0;
+            blink[i].half  = half;
+            blink[i].left  = half;
+            blink[i].edges = 2 * count;
+            blink_mask    |= _BV(i);
+            set_duty(i, 255);                /* first on phase      */
+        }
+        engine_update();
+    }
+}
+
+void led_poll(void)
+{
+    for (uint8_t i = 0; i < LED_COUNT; i++) {
+        uint8_t level, time, go;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            go    = req_mask & _BV(i);
+            level = req_level[i];
+            time  = req_time[i];
+            req_mask &= ~_BV(i);
+        }
+        if (!go) continue;
+
+        const uint16_t steps = (uint32_t)time * 10000UL / LED_FADE_TICK_US;
+        if (steps < 2) { led_set(_BV(i), level); continue; }
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (!(req_mask & _BV(i))) {            /* not superseded  */
+                const int32_t delta = ((int32_t)level << 8) - led[i].level;
+                int16_t step = delta / steps;
+                if (!step) step = (delta > 0) ? 1 : -1;
+                blink_mask   &= ~_BV(i);
+                led[i].target = level;
+                led[i].step   = delta ? step : 0;
+                engine_update();
+            }
+        }
+    }
+}
+
+uint8_t led_poll_due(void)
+{
+    return req_mask != 0;
+}
+
+uint8_t led_fading(void)
+{
+    uint8_t f = req_mask;
+    for (uint8_t i = 0; i < LED_COUNT; i++)
+        if (led[i].step) f = 1;
+    return f != 0;
+}
+
+uint8_t led_blinking(void)
+{
+    return blink_mask != 0;
+}
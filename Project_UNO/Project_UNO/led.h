@@ -0,0 +1,43 @@
+/*************************************************************
+ * led.h  — gamma-corrected dimming and fades for the two
+ *          status LEDs (UNO)
+ *
+ * PB0/PB1 have no usable compare outputs (Timer-1 belongs to
+ * the sequencer, OC1B is SS), so Timer-0 runs interrupt-driven
+ * PWM: the overflow switches the LEDs on, COMPA/COMPB switch
+ * them off.  Period 1.024 ms (clk/64, 976 Hz), 8-bit duty.
+ * Levels are perceived brightness; a PROGMEM table applies
+ * gamma 2.2.  Fades step one LED every other period, so each
+ * LED moves every LED_FADE_TICK_US.
+ *
+ * Blink patterns count PWM periods in the same overflow ISR, so
+ * the master sends one CMD_LED_BLINK and polls the status byte
+ * instead of timing each edge itself.
+ *
+ * Timer-0 only runs while an LED is dimmed, fading or blinking;
+ * a steady full-on or off LED is a plain port pin and costs
+ * nothing.
+ *************************************************************/
+#ifndef LED_H
+#define LED_H
+
+#include <stdint.h>
+#include "protocol.h"
+
+#define MOV_LED_PIN       PB0          /* D8  – movement indicator  */
+#define DOOR_LED_PIN      PB1          /* D9  – door indicator      */
+
+#define LED_COUNT         2            /* bit i of a mask = LED i   */
+#define LED_PERIOD_US     1024         /* 256 × clk/64              */
+#define LED_FADE_TICK_US  (2UL * LED_COUNT * LED_PERIOD_US)  /* 4.1 ms */
+
+void    led_init(void);
+void    led_set(uint8_t mask, uint8_t level);   /* ISR-safe, now     */
+void    led_fade(uint8_t mask, uint8_t level, uint8_t time10ms);  /* ISR-safe */
+void    led_blink(uint8_t mask, uint8_t count, uint8_t period10ms); /* ISR-safe */
+void    led_poll(void);                /* main loop: arm fades      */
+uint8_t led_poll_due(void);
+uint8_t led_fading(void);
+uint8_t led_blinking(void);
+
+#endif /* LED_H */
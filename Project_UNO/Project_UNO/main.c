@@ -7,25 +7,23 @@
  * Licence  : MIT
  ****************************************************************/
 
- #define F_CPU 16000000UL
  #include <avr/io.h>
  #include <avr/interrupt.h>
- #include <util/delay.h>
+ #include <avr/pgmspace.h>
  #include "delay.h"
  #include "protocol.h"
+ #include "audio.h"
+ #include "power.h"
+ #include "led.h"
+ #include "trace.h"
+ #include "stack.h"
  
  /*--------------------------------------------------------------------
    GPIO pin map (Arduino UNO)
    ------------------------------------------------------------------*/
- #define MOV_LED_PIN   PB0              /* D8  – movement indicator   */
- #define DOOR_LED_PIN  PB1              /* D9  – door indicator       */
- #define BUZZER_PIN    PD3              /* D3  – piezo driven by T1   */
- 
- /*--------------------------------------------------------------------
-   Runtime flags set from ISR context
-   ------------------------------------------------------------------*/
- volatile uint8_t buzzer_request = 0;   ///< 1 → play full emergency melody once
- volatile uint8_t ding_request   = 0;   ///< 1 → play short arrival chime
+ /*      MOV_LED_PIN   PB0                 D8  – movement indicator, led.h
+         DOOR_LED_PIN  PB1                 D9  – door indicator,     led.h
+         BUZZER_PIN    PD3                 D3  – piezo on OC2B,    buzzer.c */
  
  /*====================================================================
    1.  SPI-slave setup  (8 bit commands from MEGA master)
@@ -36,108 +34,162 @@
      SPCR  = _BV(SPE) | _BV(SPIE);      /* enable SPI + interrupt       */
  }
  
- /** SPI transfer-complete ISR  
-  *  Decodes one-byte opcode and sets flags or toggles LEDs instantly.
-  */
- ISR(SPI_STC_vect)
+ /* Multi-byte reply being clocked out by CMD_READ (see protocol.h) */
+ static uint8_t reply[POWER_STATS_LEN];
+ static uint8_t reply_len, reply_pos;
+ 
+ /* Stack figures for CMD_STACK_STATS.  The scan is too long for the
+    SPI ISR, so the main loop refreshes them after each query and
+    the reply carries the previous measurement.                      */
+ static uint8_t          stack_rep[STACK_STATS_LEN];
+ static volatile uint8_t stack_due = 1;
+ 
+ /* Parameterised command being collected, one argument per byte,
+    within a single SS-low frame (see protocol.h) */
+ static uint8_t rx_op, rx_need, rx_n;
+ static uint8_t rx_arg[3];
+ 
+ static uint8_t cmd_args(uint8_t op)
  {
-     switch (SPDR)
-     {
-         case CMD_MOVEMENT_LED_ON:   PORTB |=  _BV(MOV_LED_PIN);  break;
-         case CMD_MOVEMENT_LED_OFF:  PORTB &= ~_BV(MOV_LED_PIN);  break;
-         case CMD_DOOR_LED_ON:       PORTB |=  _BV(DOOR_LED_PIN); break;
-         case CMD_DOOR_LED_OFF:      PORTB &= ~_BV(DOOR_LED_PIN); break;
-         case CMD_BUZZER_PLAY_ONESHOT: buzzer_request = 1;        break;
-         case CMD_DING:                ding_request   = 1;        break;
-         default: break; /* unknown opcodes are ignored            */
+     switch (op) {
+         case CMD_LED_SET:   return 2;
+         case CMD_LED_FADE:  return 3;
+         case CMD_LED_BLINK: return 3;
+         default:            return 0;
      }
  }
  
- /*====================================================================
-   2.  Buzzer driver  (Timer-1 CTC toggles PD3 at note frequency)
-   ====================================================================*/
- static void buzzer_init(void)
+ static void run_cmd(uint8_t op, const uint8_t *arg)
  {
-     DDRD  |= _BV(BUZZER_PIN);          /* PD3 → output                */
-     TCCR1A = 0;                        /* normal port operation       */
-     TCCR1B = _BV(WGM12);               /* CTC mode, clock stopped     */
+     switch (op) {
+         case CMD_LED_SET:   led_set  (arg[0], arg[1]);         break;
+         case CMD_LED_FADE:  led_fade (arg[0], arg[1], arg[2]); break;
+         case CMD_LED_BLINK: led_blink(arg[0], arg[1], arg[2]); break;
+     }
  }
  
- /* Toggle pin every compare-match (50 % duty-cycle square wave) */
- ISR(TIMER1_COMPA_vect)
+ /** Status byte returned to the master on the next transfer. */
+ static uint8_t uno_status(void)
  {
-     PORTD ^= _BV(BUZZER_PIN);
+     uint8_t s = STATUS_READY;          /* we are answering            */
+     if (audio_busy())    s |= STATUS_AUDIO_BUSY;
+     if (audio_pending()) s |= STATUS_AUDIO_PENDING;
+     if (led_fading())    s |= STATUS_LED_FADING;
+     if (led_blinking())  s |= STATUS_LED_BLINKING;
+     return s;
  }
  
- /* ---------- low-level helpers ---------- */
- static void tone_start(uint16_t ocr1a_val)
+ /* Act on a one-byte opcode (or the first byte of a command with
+    arguments). */
+ static inline void decode(uint8_t op)
  {
-     OCR1A  = ocr1a_val;
-     TCNT1  = 0;
-     TCCR1B |= _BV(CS10);               /* clk / 1                     */
-     TIMSK1 |= _BV(OCIE1A);             /* enable toggle ISR           */
- }
+     if (op != CMD_READ) reply_len = 0; /* drop an unfinished reply    */
  
- static void tone_stop(void)
- {
-     TCCR1B &= ~_BV(CS10);              /* stop clock                  */
-     TIMSK1 &= ~_BV(OCIE1A);            /* disable ISR                 */
-     PORTD  &= ~_BV(BUZZER_PIN);        /* ensure low level            */
+     switch (op)
+     {
+         case CMD_MOVEMENT_LED_ON:   led_set(LED_MASK_MOVEMENT, 255); break;
+         case CMD_MOVEMENT_LED_OFF:  led_set(LED_MASK_MOVEMENT, 0);   break;
+         case CMD_DOOR_LED_ON:       led_set(LED_MASK_DOOR, 255);     break;
+         case CMD_DOOR_LED_OFF:      led_set(LED_MASK_DOOR, 0);       break;
+         case CMD_LED_SET:
+         case CMD_LED_FADE:
+         case CMD_LED_BLINK:                         /* args follow */
+             rx_op   = op;
+             rx_need = cmd_args(op);
+             rx_n    = 0;
+             break;
+         case CMD_BUZZER_PLAY_ONESHOT: audio_request(SND_EMERGENCY); break;
+         case CMD_DING:                audio_request(SND_DING);      break;
+         case CMD_AUDIO_STOP:          audio_stop();                 break;
+         case CMD_STATUS:            break;         /* reply only  */
+         case CMD_POWER_STATS: {
+             power_stats_t ps;
+             power_stats(&ps);
+             for (uint8_t i = 0; i < 4; i++) {
+                 reply[i]     = (uint8_t)(ps.uptime  >> (8 * i));
+                 reply[4 + i] = (uint8_t)(ps.asleep  >> (8 * i));
+                 reply[8 + i] = (uint8_t)(ps.wakeups >> (8 * i));
+             }
+             reply_len = POWER_STATS_LEN;
+             reply_pos = 0;
+         } break;
+         case CMD_STACK_STATS:
+             for (uint8_t i = 0; i < STACK_STATS_LEN; i++) reply[i] = stack_rep[i];
+             reply_len = STACK_STATS_LEN;
+             reply_pos = 0;
+             stack_due = 1;
+             break;
+         case CMD_READ:              break;         /* next byte   */
+         case CMD_TRACE_DUMP:  trace_request_dump(); break;
+         default: break; /* unknown opcodes are ignored            */
+     }
  }
  
- /* ---------- high-level helpers ---------- */
- /** Play a single note for *ms* milliseconds. */
- static void play_note(uint16_t ocr, uint16_t ms)
+ /** SPI transfer-complete ISR  
+  *  Decodes one-byte opcode, sets LEDs or hands sound requests to
+  *  the arbiter instantly (an emergency pre-empts a chime right here),
+  *  collects the arguments of parameterised commands, then preloads
+  *  the next reply byte or the status byte for the master's next
+  *  transfer.
+  */
+ ISR(SPI_STC_vect)
  {
-     tone_start(ocr);
-     while (ms--) _delay_ms(1);
-     tone_stop();
-     _delay_ms(50);                     /* inter-note gap              */
- }
+     const uint8_t b = SPDR;
+     TRACE_ISR(TR_ISR_SPI, b);
  
- /** Full 11-note emergency melody (≈1.7 s). */
- static void play_melody(void)
- {
-     play_note(27235, 62); play_note(27235, 62);  /* D4 D4 */
-     play_note(13617,104); play_note(18181,104);  /* D5 A4 */
-     play_note(19230,250); play_note(20408,250);  /* G#4 G4*/
-     play_note(22907, 62); play_note(27235, 62);  /* F4 D4 */
-     play_note(22907, 62); play_note(20408, 62);  /* F4 G4 */
-     play_note(15287, 62);                         /* C5   */
- }
+     if (!rx_need) {
+         decode(b);
+     } else {                           /* argument byte               */
+         rx_arg[rx_n++] = b;
+         if (rx_n == rx_need) {
+             rx_need = 0;
+             run_cmd(rx_op, rx_arg);
+         }
+     }
+     /* SS already high: the frame has ended, so a command still
+        waiting for arguments was cut short – drop it.              */
+     if (PINB & _BV(PB2)) rx_need = 0;
  
- /** One-shot arrival chime (≈500 Hz, 100 ms). */
- static inline void play_ding(void)
- {
-     play_note(16000, 100);             /* OCR1A=16000 → ~500 Hz       */
+     SPDR = (reply_pos < reply_len) ? reply[reply_pos++] : uno_status();
  }
  
  /*====================================================================
-   3.  Application entry point
+   2.  Application entry point
    ====================================================================*/
  int main(void)
  {
-     /* LED pins → output, start OFF */
-     DDRB  |= _BV(MOV_LED_PIN) | _BV(DOOR_LED_PIN);
-     PORTB &= ~(_BV(MOV_LED_PIN) | _BV(DOOR_LED_PIN));
+     led_init();                        /* LED pins → output, start OFF*/
  
-     buzzer_init();
+     audio_init();                      /* sequencer + buzzer/synth    */
+     power_init();                      /* Timer-1 time base, idle mode*/
      spi_slave_init();
+     trace_init();                      /* no-op unless TRACE_ENABLE   */
      sei();                             /* global IRQ enable           */
  
      /* ---------- super-loop ---------- */
      for (;;)
      {
-         if (buzzer_request) {          /* play full melody once       */
-             buzzer_request = 0;
-             play_melody();
+         /* Requests start from the SPI ISR; only queued ones are
+            started here, once the sound in progress has ended.      */
+         audio_poll();
+         led_poll();                    /* arm requested fades         */
+         if (trace_dump_due()) trace_dump();
+         if (stack_due) {
+             uint8_t s[STACK_STATS_LEN];
+             stack_report(s);
+             cli();
+             for (uint8_t i = 0; i < STACK_STATS_LEN; i++) stack_rep[i] = s[i];
+             stack_due = 0;
+             sei();
          }
- 
-         if (ding_request) {            /* play single arrival chime   */
-             ding_request = 0;
-             play_ding();
-         }
-         /* CPU sleeps in idle between ISR events (optional)          */
+
+         /* Idle sleep until the next interrupt.  The check runs with
+            IRQs off and power_sleep() re-enables them right before
+            SLEEP, so a command that lands after the check still wakes
+            the CPU instead of waiting for the following interrupt.  */
+         cli();
+         if (audio_poll_due() || led_poll_due() || trace_dump_due() || stack_due) sei();
+         else                  power_sleep();
      }
  }
  
\ No newline at end of file
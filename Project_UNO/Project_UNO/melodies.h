@@ -0,0 +1,25 @@
+/*************************************************************
+ * melodies.h  — generated by tools/rtttl2c from melodies.rtttl
+ *               Do not edit; run `make -C tools melodies`.
+ *************************************************************/
+#ifndef MELODIES_H
+#define MELODIES_H
+
+#include <avr/pgmspace.h>
+#include "sequencer.h"
+
+/* emergency:d=16,o=4,b=240:d,d,d5.,a.,4g#,4g,f,d,f,g,c5 */
+static const seq_note_t melody_emergency[] PROGMEM = {
+    SEQ_NOTE(D4, 63), SEQ_NOTE(D4, 63), SEQ_NOTE(D5, 94), SEQ_NOTE(A4, 94),
+    SEQ_NOTE(GS4, 250), SEQ_NOTE(G4, 250), SEQ_NOTE(F4, 63), SEQ_NOTE(D4, 63),
+    SEQ_NOTE(F4, 63), SEQ_NOTE(G4, 63), SEQ_NOTE(C5, 63),
+    SEQ_END
+};   /* 11 notes, 1129 ms + gaps */
+
+/* ding:d=4,o=4,b=600:b */
+static const seq_note_t melody_ding[] PROGMEM = {
+    SEQ_NOTE(B4, 100),
+    SEQ_END
+};   /* 1 note, 100 ms + gaps */
+
+#endif /* MELODIES_H */
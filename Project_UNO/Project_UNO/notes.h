@@ -0,0 +1,58 @@
+/*************************************************************
+ * notes.h  — equal-tempered note table, C4..B6 (A4 = 440 Hz)
+ *
+ * NOTE_LIST(X) expands X(name, centi-Hz) once per note.  The
+ * sequencer turns it into a PROGMEM table of timer values with
+ * SEQ_PITCH_CHZ(), so every pitch is folded by the compiler from
+ * F_CPU and the selected prescaler.  Index 0 is a rest.
+ *************************************************************/
+#ifndef NOTES_H
+#define NOTES_H
+
+#define NOTE_LIST(X) \
+    X(C4,    26163)   /*  1 */ \
+    X(CS4,   27718)   /*  2 */ \
+    X(D4,    29366)   /*  3 */ \
+    X(DS4,   31113)   /*  4 */ \
+    X(E4,    32963)   /*  5 */ \
+    X(F4,    34923)   /*  6 */ \
+    X(FS4,   36999)   /*  7 */ \
+    X(G4,    39200)   /*  8 */ \
+    X(GS4,   41530)   /*  9 */ \
+    X(A4,    44000)   /* 10 */ \
+    X(AS4,   46616)   /* 11 */ \
+    X(B4,    49388)   /* 12 */ \
+    X(C5,    52325)   /* 13 */ \
+    X(CS5,   55437)   /* 14 */ \
+    X(D5,    58733)   /* 15 */ \
+    X(DS5,   62225)   /* 16 */ \
+    X(E5,    65926)   /* 17 */ \
+    X(F5,    69846)   /* 18 */ \
+    X(FS5,   73999)   /* 19 */ \
+    X(G5,    78399)   /* 20 */ \
+    X(GS5,   83061)   /* 21 */ \
+    X(A5,    88000)   /* 22 */ \
+    X(AS5,   93233)   /* 23 */ \
+    X(B5,    98777)   /* 24 */ \
+    X(C6,   104650)   /* 25 */ \
+    X(CS6,  110873)   /* 26 */ \
+    X(D6,   117466)   /* 27 */ \
+    X(DS6,  124451)   /* 28 */ \
+    X(E6,   131851)   /* 29 */ \
+    X(F6,   139691)   /* 30 */ \
+    X(FS6,  147998)   /* 31 */ \
+    X(G6,   156798)   /* 32 */ \
+    X(GS6,  166122)   /* 33 */ \
+    X(A6,   176000)   /* 34 */ \
+    X(AS6,  186466)   /* 35 */ \
+    X(B6,   197553)   /* 36 */ \
+
+enum {
+    NOTE_REST = 0,
+#define X(name, chz) NOTE_##name,
+    NOTE_LIST(X)
+#undef X
+    NOTE_COUNT
+};
+
+#endif /* NOTES_H */
@@ -0,0 +1,61 @@
+/*************************************************************
+ * power.c  — idle sleep, Timer-1 time base, counters (UNO)
+ *************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "power.h"
+#include "trace.h"
+
+static volatile uint16_t epoch;        /* Timer-1 overflows (4.19 s) */
+static uint32_t          asleep;
+static uint32_t          wakeups;
+
+ISR(TIMER1_OVF_vect)
+{
+    TRACE_ISR(TR_ISR_EPOCH, 0);
+    epoch++;
+}
+
+/* 32-bit Timer-1 time; IRQs disabled, so a pending overflow is
+   folded in by hand.                                              */
+static uint32_t now(void)
+{
+    uint16_t hi = epoch;
+    const uint16_t lo = TCNT1;
+    if ((TIFR1 & _BV(TOV1)) && lo < 0x8000) hi++;
+    return (uint32_t)hi << 16 | lo;
+}
+
+void power_init(void)
+{
+    PRR   |= _BV(PRTWI) | _BV(PRADC);  /* unused peripherals off    */
+    ACSR  |= _BV(ACD);                 /* analog comparator off     */
+    TIFR1  = _BV(TOV1);
+    TIMSK1 |= _BV(TOIE1);              /* Timer-1 runs from seq_init */
+    set_sleep_mode(SLEEP_MODE_IDLE);
+}
+
+/** Sleep until the next interrupt.  Returns with IRQs enabled. */
+void power_sleep(void)
+{
+    const uint32_t t0 = now();
+
+    sleep_enable();
+    sei();                             /* takes effect after SLEEP  */
+    sleep_cpu();
+    sleep_disable();
+
+    /* the waking ISR has already run; its time counts as asleep  */
+    cli();
+    asleep += now() - t0;
+    wakeups++;
+    sei();
+}
+
+void power_stats(power_stats_t *s)
+{
+    s->uptime  = now();
+    s->asleep  = asleep;
+    s->wakeups = wakeups;
+}
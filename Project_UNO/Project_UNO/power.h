@@ -0,0 +1,30 @@
+/*************************************************************
+ * power.h  — idle sleep and power-state counters (UNO)
+ *
+ * The super-loop calls power_sleep() with interrupts disabled
+ * once it has checked that no main-loop work is left.  SLEEP
+ * follows SEI directly, so an interrupt that arrives after the
+ * check still wakes the CPU and is never lost.  Idle mode keeps
+ * SPI and all timers running.
+ *
+ * Time is counted in Timer-1 counts (64 us); the overflow
+ * interrupt extends the free-running TCNT1 to 32 bits.
+ *************************************************************/
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+#define POWER_COUNT_US    64           /* one Timer-1 count        */
+
+typedef struct {
+    uint32_t uptime;                   /* counts since boot         */
+    uint32_t asleep;                   /* counts spent in idle sleep */
+    uint32_t wakeups;                  /* sleep exits               */
+} power_stats_t;
+
+void power_init(void);                 /* after audio_init()        */
+void power_sleep(void);                /* call with IRQs disabled   */
+void power_stats(power_stats_t *s);    /* call with IRQs disabled   */
+
+#endif /* POWER_H */
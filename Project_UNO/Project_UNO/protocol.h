@@ -10,11 +10,52 @@
 #define CMD_DOOR_LED_ON       0x12
 #define CMD_DOOR_LED_OFF      0x13
 
+/* Parameterised LED commands: opcode and arguments in one SS-low
+   frame, ~20 us between bytes; a frame cut short is dropped.
+   Levels are perceived brightness 0..255 (the UNO applies gamma). */
+#define CMD_LED_SET           0x14   /* mask, level                 */
+#define CMD_LED_FADE          0x15   /* mask, level, time (x 10 ms) */
+#define CMD_LED_BLINK         0x16   /* mask, count, period (x 10 ms);
+                                        ends off, status bit below  */
+#define LED_MASK_MOVEMENT     0x01
+#define LED_MASK_DOOR         0x02
+
 /* Emergency – play buzzer melody once */
 #define CMD_BUZZER_PLAY_ONESHOT 0x20
 
+/* Cancel the playing melody and any queued sound */
+#define CMD_AUDIO_STOP          0x21
+
 /* additional feature ding */
 #define CMD_DING 0x25
 
+/* Status query – no action.  After every byte the UNO preloads its
+   status into SPDR, so the reply arrives on the *next* transfer. */
+#define CMD_STATUS            0x30
+
+#define STATUS_AUDIO_BUSY     0x01   /* sequencer is playing        */
+#define STATUS_AUDIO_PENDING  0x02   /* melody or ding queued       */
+#define STATUS_LED_FADING     0x04   /* an LED fade is running      */
+#define STATUS_LED_BLINKING   0x08   /* a blink pattern is running  */
+#define STATUS_READY          0x40   /* always set once the SPI ISR
+                                        runs; until then the MEGA
+                                        reads 0x00, or 0xFF with
+                                        MISO pulled up               */
+
+/* Multi-byte replies.  A query loads a reply buffer on the UNO; the
+   master clocks it out with CMD_READ, one byte per transfer (after
+   the same ~20 us pause as for CMD_STATUS).  Any other opcode
+   discards the rest of the reply.                                */
+#define CMD_POWER_STATS       0x31   /* u32 uptime, u32 asleep (64 us
+                                        counts), u32 wakeups; LE     */
+#define CMD_TRACE_DUMP        0x32   /* send the trace ring on the
+                                        UNO's USART (trace.h)       */
+#define CMD_STACK_STATS       0x33   /* u16 static, u16 unused since
+                                        reset, u16 gap now; LE
+                                        (stack.h)                    */
+#define CMD_READ              0x3F
+#define POWER_STATS_LEN       12
+#define STACK_STATS_LEN       6
+
 
 #endif /* PROTOCOL_H */
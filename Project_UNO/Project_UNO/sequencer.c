@@ -0,0 +1,147 @@
+/*************************************************************
+ * sequencer.c  — melody playback from flash, Timer-1 COMPA/B
+ *************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "sequencer.h"
+#include "trace.h"
+
+typedef struct {
+    const seq_note_t *cur;             /* next record (PROGMEM)     */
+    volatile uint8_t  busy;
+    uint8_t           in_note;         /* 1 → gap follows           */
+#if AUDIO_SYNTH
+    const synth_instr_t *instr;
+#endif
+} seq_chan_t;
+
+static seq_chan_t chan[SEQ_CHANNELS];
+
+/* Timer value per NOTE_xx, computed by the compiler from notes.h */
+static const uint16_t seq_pitch[NOTE_COUNT] PROGMEM = {
+    0,                                 /* NOTE_REST                 */
+#define X(name, chz) SEQ_PITCH_CHZ(chz),
+    NOTE_LIST(X)
+#undef X
+};
+
+#if !AUDIO_SYNTH
+_Static_assert(SEQ_PITCH_CHZ(26163) <= 255, "C4 below the Timer-2 range");
+#endif
+
+/* Compare unit of channel *ch* (constant-folded in the ISRs) */
+#define SEQ_OCR(ch)    (*((ch) ? &OCR1B : &OCR1A))
+#define SEQ_OCIE(ch)   ((ch) ? _BV(OCIE1B) : _BV(OCIE1A))
+#define SEQ_OCF(ch)    ((ch) ? _BV(OCF1B)  : _BV(OCF1A))
+
+/* --- audio back-end ---------------------------------------------- */
+static inline void note_on(uint8_t ch, uint16_t pitch)
+{
+#if AUDIO_SYNTH
+    synth_note_on(ch, pitch, chan[ch].instr);
+#else
+    (void)ch;
+    tone_start(pitch);
+#endif
+}
+
+static inline void note_off(uint8_t ch)
+{
+#if AUDIO_SYNTH
+    synth_note_off(ch);
+#else
+    (void)ch;
+    tone_stop();
+#endif
+}
+
+/* Load the next record and schedule its end relative to OCRx. */
+static inline void seq_next(uint8_t ch)
+{
+    seq_chan_t    *c     = &chan[ch];
+    const uint16_t len   = pgm_read_word(&c->cur->len);
+    const uint16_t pitch = pgm_read_word(&seq_pitch[pgm_read_byte(&c->cur->note)]);
+
+    if (len == 0) {                    /* SEQ_END                   */
+        TIMSK1 &= ~SEQ_OCIE(ch);
+        c->busy = 0;
+        return;
+    }
+    c->cur++;
+    if (pitch) note_on(ch, pitch);
+    c->in_note   = (pitch != 0);
+    SEQ_OCR(ch) += len;
+}
+
+/* One interrupt per note edge: note → gap → next note ... */
+static inline void seq_edge(uint8_t ch)
+{
+    if (chan[ch].in_note) {
+        note_off(ch);
+        chan[ch].in_note = 0;
+        SEQ_OCR(ch) += SEQ_MS(SEQ_GAP_MS);
+        return;
+    }
+    seq_next(ch);
+}
+
+ISR(TIMER1_COMPA_vect) { TRACE_ISR(TR_ISR_SEQ, 0); seq_edge(0); }
+#if SEQ_CHANNELS > 1
+ISR(TIMER1_COMPB_vect) { TRACE_ISR(TR_ISR_SEQ, 1); seq_edge(1); }
+#endif
+
+void seq_init(void)
+{
+    TCCR1A = 0;                        /* normal mode               */
+    TCCR1B = _BV(CS12) | _BV(CS10);    /* free-running, clk/1024    */
+#if AUDIO_SYNTH
+    synth_init();
+    chan[SEQ_CH_MELODY].instr = &instr_reed;
+    chan[SEQ_CH_CHIME].instr  = &instr_bell;
+#else
+    buzzer_init();
+#endif
+}
+
+#if AUDIO_SYNTH
+void seq_set_instrument(uint8_t ch, const synth_instr_t *instr)
+{
+    if (ch < SEQ_CHANNELS) chan[ch].instr = instr;
+}
+#endif
+
+/** Start *melody* on *ch* now, replacing whatever it was playing. */
+void seq_play(uint8_t ch, const seq_note_t *melody)
+{
+    if (ch >= SEQ_CHANNELS) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        seq_chan_t *c = &chan[ch];
+        if (c->in_note) note_off(ch);
+        c->cur     = melody;
+        c->busy    = 1;
+        c->in_note = 0;
+        SEQ_OCR(ch) = TCNT1;
+        seq_next(ch);
+        TIFR1 = SEQ_OCF(ch);           /* drop a stale match        */
+        if (c->busy) TIMSK1 |= SEQ_OCIE(ch);
+    }
+}
+
+void seq_stop(uint8_t ch)
+{
+    if (ch >= SEQ_CHANNELS) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TIMSK1 &= ~SEQ_OCIE(ch);
+        if (chan[ch].in_note) note_off(ch);
+        chan[ch].busy    = 0;
+        chan[ch].in_note = 0;
+    }
+}
+
+uint8_t seq_busy(uint8_t ch)
+{
+    return ch < SEQ_CHANNELS && chan[ch].busy;
+}
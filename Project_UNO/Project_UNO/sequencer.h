@@ -0,0 +1,64 @@
+/*************************************************************
+ * sequencer.h  — interrupt-driven melody player (UNO)
+ *
+ * A melody is a PROGMEM array of seq_note_t terminated by
+ * SEQ_END; notes are indices into a compile-time pitch table.
+ * Timer-1 free-runs at clk/1024 (64 us); each channel owns one
+ * compare unit (A, B) that is re-armed once per note edge, so
+ * playback costs one short interrupt per note and the main
+ * loop stays free.
+ *
+ * With AUDIO_SYNTH the two channels drive synth voices 0 and 1
+ * and are mixed; otherwise there is a single square-wave channel.
+ *************************************************************/
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "buzzer.h"
+#include "synth.h"
+#include "notes.h"
+
+#define SEQ_GAP_MS      50             /* silence after every note  */
+
+/* Timer value for a pitch in centi-Hz, folded at compile time from
+   F_CPU, a project symbol (Project_UNO.cproj, -D)                */
+#if AUDIO_SYNTH
+#define SEQ_CHANNELS    2
+#define SEQ_PITCH_CHZ(chz) \
+        ((uint16_t)(((chz) * 65536ULL + SYNTH_RATE * 50ULL) / (SYNTH_RATE * 100ULL)))
+#else
+#define SEQ_CHANNELS    1
+#define SEQ_PITCH_CHZ(chz) \
+        ((uint16_t)((F_CPU * 100ULL / TONE_PRESCALER + (chz) / 2) / (chz) - 1))
+#endif
+
+#define SEQ_CH_MELODY   0
+#define SEQ_CH_CHIME    (SEQ_CHANNELS - 1)   /* shares ch 0 if mono */
+
+/** Duration in Timer-1 counts; max 4194 ms. */
+#define SEQ_MS(ms)      ((uint16_t)(((uint32_t)(ms) * (F_CPU / 1024UL) + 500) / 1000))
+
+/* 3 bytes per note (the project builds with -fpack-struct) */
+typedef struct {
+    uint8_t  note;                     /* NOTE_xx, NOTE_REST = 0    */
+    uint16_t len;                      /* Timer-1 counts, 0 = end   */
+} seq_note_t;
+
+/* Melodies are normally generated from RTTTL by tools/rtttl2c
+   (see melodies.rtttl); *ms* is the sounding time of the note. */
+#define SEQ_NOTE(n, ms)   { NOTE_##n,  SEQ_MS(ms) }
+#define SEQ_REST(ms)      { NOTE_REST, SEQ_MS(ms) }
+#define SEQ_END           { NOTE_REST, 0 }
+
+void    seq_init(void);
+void    seq_play(uint8_t ch, const seq_note_t *melody);   /* PROGMEM */
+void    seq_stop(uint8_t ch);
+uint8_t seq_busy(uint8_t ch);
+
+#if AUDIO_SYNTH
+void    seq_set_instrument(uint8_t ch, const synth_instr_t *instr);
+#endif
+
+#endif /* SEQUENCER_H */
@@ -0,0 +1,46 @@
+/*************************************************************
+ * stack.c  — stack painting and high-water mark (see stack.h)
+ *************************************************************/
+#include <avr/io.h>
+#include "protocol.h"
+#include "stack.h"
+
+extern uint8_t __heap_start;           /* end of .bss (linker)      */
+extern char   *__brkval;               /* malloc() top, 0 = unused  */
+
+/* .init1 runs straight after reset: no stack frame, r1 not yet
+   cleared, so plain asm.  Paints from __heap_start up to and
+   including __stack (RAMEND).                                     */
+void stack_paint(void) __attribute__((naked, used, section(".init1")));
+void stack_paint(void)
+{
+    __asm__ __volatile__ (
+        "    ldi  r30, lo8(__heap_start)\n"
+        "    ldi  r31, hi8(__heap_start)\n"
+        "    ldi  r24, %0\n"
+        "    ldi  r25, hi8(__stack)\n"
+        "    rjmp 2f\n"
+        "1:  st   Z+, r24\n"
+        "2:  cpi  r30, lo8(__stack)\n"
+        "    cpc  r31, r25\n"
+        "    brlo 1b\n"
+        "    breq 1b\n"
+        :: "M" (STACK_PAINT));
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void stack_report(uint8_t *p)
+{
+    const uint8_t *const heap_end = __brkval ? (const uint8_t *)__brkval : &__heap_start;
+    const uint8_t *q = heap_end;
+    while (q <= (const uint8_t *)RAMEND && *q == STACK_PAINT) q++;
+
+    put16(p,     (uint16_t)&__heap_start - RAMSTART);
+    put16(p + 2, (uint16_t)(q - heap_end));
+    put16(p + 4, SP - (uint16_t)heap_end);
+}
@@ -0,0 +1,29 @@
+/*************************************************************
+ * stack.h  — stack painting and high-water mark (MEGA and UNO)
+ *
+ * Before main(), stack.c fills the RAM between the end of .bss
+ * and the top of RAM with STACK_PAINT.  Bytes the stack (or
+ * the heap) has never reached still hold the pattern, so the
+ * unbroken run of it above the heap end is the closest the two
+ * have come since reset — ISRs and sprintf() included.
+ *
+ * stack_report() writes STACK_STATS_LEN bytes, little-endian
+ * (the CMD_STACK_STATS reply and the TLM_STACK payload):
+ *
+ *   u16 static    .data + .bss
+ *   u16 unused    never touched since reset: the high-water gap
+ *   u16 gap       free right now between heap end and SP
+ *
+ * The scan reads every untouched byte (~7 cycles each, about
+ * 3 ms on the MEGA), so call it from the main loop only.
+ *************************************************************/
+#ifndef STACK_H
+#define STACK_H
+
+#include <stdint.h>
+
+#define STACK_PAINT   0xC5
+
+void stack_report(uint8_t *p);
+
+#endif /* STACK_H */
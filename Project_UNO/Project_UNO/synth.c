@@ -0,0 +1,213 @@
+/*************************************************************
+ * synth.c  — DDS sample interrupt, voices and envelopes (UNO)
+ *************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "synth.h"
+#include "trace.h"
+
+#if AUDIO_SYNTH
+
+/* Mix scale (8.8): full-scale sum of all voices → ±(TOP+1)/2      */
+#define SYNTH_MID    ((SYNTH_TOP + 1) / 2)
+#define SYNTH_GAIN   ((int16_t)(SYNTH_MID * 256L / (127L * SYNTH_VOICES)))
+
+/* Round-robin: one voice's envelope per SYNTH_ENV_DIV/VOICES samples,
+   so every voice is updated once per SYNTH_ENV_DIV samples and the
+   ISR never does more than one envelope step.                     */
+#define ENV_SLOT     (SYNTH_ENV_DIV / SYNTH_VOICES)
+
+enum { ENV_OFF, ENV_ATTACK, ENV_DECAY, ENV_SUSTAIN, ENV_RELEASE };
+
+/* sin(), one period */
+static const int8_t wave_sine[256] PROGMEM = {
+       0,    3,    6,    9,   12,   16,   19,   22,   25,   28,   31,   34,   37,   40,   43,   46,
+      49,   51,   54,   57,   60,   63,   65,   68,   71,   73,   76,   78,   81,   83,   85,   88,
+      90,   92,   94,   96,   98,  100,  102,  104,  106,  107,  109,  111,  112,  113,  115,  116,
+     117,  118,  120,  121,  122,  122,  123,  124,  125,  125,  126,  126,  126,  127,  127,  127,
+     127,  127,  127,  127,  126,  126,  126,  125,  125,  124,  123,  122,  122,  121,  120,  118,
+     117,  116,  115,  113,  112,  111,  109,  107,  106,  104,  102,  100,   98,   96,   94,   92,
+      90,   88,   85,   83,   81,   78,   76,   73,   71,   68,   65,   63,   60,   57,   54,   51,
+      49,   46,   43,   40,   37,   34,   31,   28,   25,   22,   19,   16,   12,    9,    6,    3,
+       0,   -3,   -6,   -9,  -12,  -16,  -19,  -22,  -25,  -28,  -31,  -34,  -37,  -40,  -43,  -46,
+     -49,  -51,  -54,  -57,  -60,  -63,  -65,  -68,  -71,  -73,  -76,  -78,  -81,  -83,  -85,  -88,
+     -90,  -92,  -94,  -96,  -98, -100, -102, -104, -106, -107, -109, -111, -112, -113, -115, -116,
+    -117, -118, -120, -121, -122, -122, -123, -124, -125, -125, -126, -126, -126, -127, -127, -127,
+    -127, -127, -127, -127, -126, -126, -126, -125, -125, -124, -123, -122, -122, -121, -120, -118,
+    -117, -116, -115, -113, -112, -111, -109, -107, -106, -104, -102, -100,  -98,  -96,  -94,  -92,
+     -90,  -88,  -85,  -83,  -81,  -78,  -76,  -73,  -71,  -68,  -65,  -63,  -60,  -57,  -54,  -51,
+     -49,  -46,  -43,  -40,  -37,  -34,  -31,  -28,  -25,  -22,  -19,  -16,  -12,   -9,   -6,   -3
+};
+
+/* square, harmonics 1,3,5,7 only (no aliasing up to ~2 kHz) */
+static const int8_t wave_reed[256] PROGMEM = {
+       0,   13,   27,   39,   52,   64,   75,   85,   94,  102,  109,  115,  119,  123,  125,  127,
+     127,  127,  125,  124,  121,  119,  116,  113,  110,  107,  104,  101,   99,   98,   97,   96,
+      96,   96,   97,   98,   99,  101,  102,  104,  106,  108,  110,  112,  114,  115,  116,  116,
+     116,  116,  116,  115,  114,  112,  111,  109,  107,  106,  104,  103,  101,  100,   99,   99,
+      99,   99,   99,  100,  101,  103,  104,  106,  107,  109,  111,  112,  114,  115,  116,  116,
+     116,  116,  116,  115,  114,  112,  110,  108,  106,  104,  102,  101,   99,   98,   97,   96,
+      96,   96,   97,   98,   99,  101,  104,  107,  110,  113,  116,  119,  121,  124,  125,  127,
+     127,  127,  125,  123,  119,  115,  109,  102,   94,   85,   75,   64,   52,   39,   27,   13,
+       0,  -13,  -27,  -39,  -52,  -64,  -75,  -85,  -94, -102, -109, -115, -119, -123, -125, -127,
+    -127, -127, -125, -124, -121, -119, -116, -113, -110, -107, -104, -101,  -99,  -98,  -97,  -96,
+     -96,  -96,  -97,  -98,  -99, -101, -102, -104, -106, -108, -110, -112, -114, -115, -116, -116,
+    -116, -116, -116, -115, -114, -112, -111, -109, -107, -106, -104, -103, -101, -100,  -99,  -99,
+     -99,  -99,  -99, -100, -101, -103, -104, -106, -107, -109, -111, -112, -114, -115, -116, -116,
+    -116, -116, -116, -115, -114, -112, -110, -108, -106, -104, -102, -101,  -99,  -98,  -97,  -96,
+     -96,  -96,  -97,  -98,  -99, -101, -104, -107, -110, -113, -116, -119, -121, -124, -125, -127,
+    -127, -127, -125, -123, -119, -115, -109, -102,  -94,  -85,  -75,  -64,  -52,  -39,  -27,  -13
+};
+
+const synth_instr_t instr_bell PROGMEM = {
+    wave_sine, SYNTH_ENV_STEP(2), SYNTH_ENV_STEP(400), 0, SYNTH_ENV_STEP(120)
+};
+const synth_instr_t instr_reed PROGMEM = {
+    wave_reed, SYNTH_ENV_STEP(8), SYNTH_ENV_STEP(60), 180, SYNTH_ENV_STEP(30)
+};
+
+/* --- per-voice state: sample path ------------------------------- */
+static uint16_t          phase[SYNTH_VOICES];
+static uint16_t          inc  [SYNTH_VOICES];
+static const int8_t     *wave [SYNTH_VOICES];
+static uint8_t           amp  [SYNTH_VOICES];
+
+/* --- per-voice state: envelope ---------------------------------- */
+static uint16_t          level[SYNTH_VOICES];
+static uint8_t           stage[SYNTH_VOICES];
+static synth_instr_t     env  [SYNTH_VOICES];
+
+static uint8_t           env_div = ENV_SLOT;
+static uint8_t           env_voice;
+static volatile uint8_t  active;
+
+#if SYNTH_PROFILE
+volatile uint16_t synth_isr_max;
+#endif
+
+static void synth_halt(void)
+{
+    TIMSK2 &= ~_BV(TOIE2);
+    TCCR2B  = _BV(WGM22);              /* stop clock                */
+    TCCR2A &= ~_BV(COM2B1);            /* pin back to PORTD (low)   */
+    active  = 0;
+}
+
+/* One ADSR step for voice *v*; halts the engine once all are off. */
+static inline void env_step(uint8_t v)
+{
+    uint16_t l = level[v];
+
+    switch (stage[v]) {
+    case ENV_ATTACK:
+        if (l > 0xFFFF - env[v].attack) { l = 0xFFFF; stage[v] = ENV_DECAY; }
+        else l += env[v].attack;
+        break;
+    case ENV_DECAY: {
+        const uint16_t sus = (uint16_t)env[v].sustain << 8;
+        if ((uint16_t)(l - sus) <= env[v].decay) { l = sus; stage[v] = ENV_SUSTAIN; }
+        else l -= env[v].decay;
+    } break;
+    case ENV_RELEASE:
+        if (l <= env[v].release) {
+            l = 0;
+            stage[v] = ENV_OFF;
+            uint8_t any = 0;
+            for (uint8_t i = 0; i < SYNTH_VOICES; i++) any |= stage[i];
+            if (!any) synth_halt();
+        } else l -= env[v].release;
+        break;
+    default:
+        break;
+    }
+    level[v] = l;
+    amp[v]   = l >> 8;
+}
+
+/* Sample-rate interrupt: advance, look up, scale and mix every voice. */
+ISR(TIMER2_OVF_vect)
+{
+    TRACE_ISR_HF(TR_ISR_SYNTH, 0);
+    int16_t mix = 0;
+
+    for (uint8_t v = 0; v < SYNTH_VOICES; v++) {
+        const uint16_t ph = phase[v] + inc[v];
+        phase[v] = ph;
+        const int8_t s = pgm_read_byte(wave[v] + (ph >> 8));
+        mix += (s * amp[v]) >> 8;
+    }
+    OCR2B = SYNTH_MID + ((mix * SYNTH_GAIN) >> 8);
+
+    if (!--env_div) {
+        env_div = ENV_SLOT;
+        env_step(env_voice);
+        if (++env_voice == SYNTH_VOICES) env_voice = 0;
+    }
+
+#if SYNTH_PROFILE
+    const uint16_t c = (uint16_t)TCNT2 * 8;    /* since overflow   */
+    if (c > synth_isr_max) synth_isr_max = c;
+#endif
+}
+
+void synth_init(void)
+{
+    DDRD  |= _BV(PD3);                 /* OC2B → output             */
+    PORTD &= ~_BV(PD3);
+    for (uint8_t v = 0; v < SYNTH_VOICES; v++) wave[v] = wave_sine;
+    synth_halt();
+}
+
+/** (Re)start *voice* at phase step *inc* with envelope *instr* (PROGMEM). */
+void synth_note_on(uint8_t voice, uint16_t step, const synth_instr_t *instr)
+{
+    if (voice >= SYNTH_VOICES) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        memcpy_P(&env[voice], instr, sizeof env[voice]);
+        wave [voice] = env[voice].wave;
+        inc  [voice] = step;
+        stage[voice] = ENV_ATTACK;     /* from the current level    */
+        env_step(voice);               /* audible from next sample  */
+
+        if (!active) {
+            active = 1;
+            OCR2A  = SYNTH_TOP;
+            OCR2B  = SYNTH_MID;
+            TCNT2  = SYNTH_TOP;        /* first sample on next tick */
+            TCCR2A = _BV(COM2B1) | _BV(WGM21) | _BV(WGM20);
+            TCCR2B = _BV(WGM22) | _BV(CS21);           /* clk/8     */
+            TIFR2  = _BV(TOV2);
+            TIMSK2 |= _BV(TOIE2);
+        }
+    }
+}
+
+void synth_note_off(uint8_t voice)
+{
+    if (voice >= SYNTH_VOICES) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (stage[voice] != ENV_OFF) stage[voice] = ENV_RELEASE;
+    }
+}
+
+/** Silence everything at once (no release tail). */
+void synth_stop(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t v = 0; v < SYNTH_VOICES; v++) {
+            stage[v] = ENV_OFF;
+            level[v] = 0;
+            amp[v]   = 0;
+        }
+        synth_halt();
+    }
+}
+
+uint8_t synth_active(void)
+{
+    return active;
+}
+
+#endif /* AUDIO_SYNTH */
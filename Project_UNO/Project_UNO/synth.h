@@ -0,0 +1,84 @@
+/*************************************************************
+ * synth.h  — direct-digital-synthesis audio engine (UNO)
+ *
+ * Timer-2 runs fast PWM (mode 7, clk/8) on OC2B as an ultrasonic
+ * carrier; its overflow is the sample-rate interrupt.  Each voice
+ * is a 16-bit phase accumulator stepping through a 256-entry
+ * PROGMEM wavetable, scaled by an ADSR amplitude envelope.  The
+ * voices are summed and written to OCR2B.
+ *
+ * Build options (project symbols or -D):
+ *   AUDIO_SYNTH       1 = use this engine, 0 = plain square (buzzer.c)
+ *   SYNTH_VOICES      2..4 voices, all mixed every sample
+ *   SYNTH_SAMPLE_HZ   16000..32000
+ *   SYNTH_PROFILE     1 = record the worst-case ISR length
+ *************************************************************/
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#ifndef AUDIO_SYNTH
+#define AUDIO_SYNTH       1
+#endif
+#ifndef SYNTH_VOICES
+#define SYNTH_VOICES      2
+#endif
+#ifndef SYNTH_SAMPLE_HZ
+#define SYNTH_SAMPLE_HZ   32000UL
+#endif
+#ifndef SYNTH_PROFILE
+#define SYNTH_PROFILE     0
+#endif
+
+#if SYNTH_VOICES < 1 || SYNTH_VOICES > 4
+#error "SYNTH_VOICES must be 1..4"
+#endif
+
+/* Carrier / sample clock: TOP = OCR2A, one sample per PWM period.
+   F_CPU is a project symbol; in #if an undefined one reads as 0.  */
+#ifndef F_CPU
+#error "F_CPU not defined: add F_CPU=16000000UL to the project symbols"
+#endif
+#define SYNTH_TOP         (F_CPU / 8 / SYNTH_SAMPLE_HZ - 1)
+#define SYNTH_RATE        (F_CPU / 8 / (SYNTH_TOP + 1))  /* actual Hz */
+
+#if SYNTH_TOP > 255 || SYNTH_TOP < 31
+#error "SYNTH_SAMPLE_HZ out of range for Timer-2 at clk/8"
+#endif
+
+/** Phase increment for *hz*; evaluated by the compiler. */
+#define SYNTH_INC(hz)     ((uint16_t)(((uint32_t)(hz) * 65536UL + SYNTH_RATE / 2) / SYNTH_RATE))
+
+/* Envelopes advance every 48 samples (~1.5 ms at 32 kHz); 48 splits
+   evenly into 1..4 round-robin slots                              */
+#define SYNTH_ENV_DIV     48
+#define SYNTH_ENV_HZ      (SYNTH_RATE / SYNTH_ENV_DIV)
+
+/** 16-bit level step to sweep full scale in *ms* milliseconds. */
+#define SYNTH_ENV_STEP(ms) ((uint16_t)((ms) * SYNTH_ENV_HZ / 1000 ? \
+            65535UL / ((uint32_t)(ms) * SYNTH_ENV_HZ / 1000) : 65535UL))
+
+typedef struct {
+    const int8_t *wave;                /* PROGMEM, 256 samples       */
+    uint16_t      attack;              /* SYNTH_ENV_STEP(ms)         */
+    uint16_t      decay;
+    uint8_t       sustain;             /* 0..255                     */
+    uint16_t      release;
+} synth_instr_t;
+
+extern const synth_instr_t instr_bell PROGMEM;  /* sine, struck, rings out */
+extern const synth_instr_t instr_reed PROGMEM;  /* odd harmonics, held     */
+
+void    synth_init(void);
+void    synth_note_on(uint8_t voice, uint16_t inc, const synth_instr_t *instr);
+void    synth_note_off(uint8_t voice);
+void    synth_stop(void);
+uint8_t synth_active(void);
+
+#if SYNTH_PROFILE
+extern volatile uint16_t synth_isr_max;  /* cycles, 8-cycle resolution */
+#endif
+
+#endif /* SYNTH_H */
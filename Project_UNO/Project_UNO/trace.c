@@ -0,0 +1,94 @@
+/*************************************************************
+ * trace.c  — trace ring and its dump (UNO)
+ *
+ * The MEGA forwards a dump request as CMD_TRACE_DUMP; the main
+ * loop then sends a snapshot of the ring as TLM_TRACE records
+ * on USART0 (the UNO's USB port), in the MEGA's telemetry
+ * framing so tools/teledec reads both ports.  The writer blocks
+ * (~110 ms for a full ring); sound and LEDs run from ISRs.  The
+ * ring is read in place, oldest first: 768 B do not fit on the
+ * stack twice, and the ISRs add entries far slower than the
+ * dump reads them.
+ *************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <string.h>
+#include "trace.h"
+
+#if TRACE_ENABLE == 1
+
+trace_ev_t trace_buf[TRACE_DEPTH];
+uint8_t    trace_head;
+
+static volatile uint8_t dump_req;
+
+void trace_init(void)
+{
+    UBRR0  = (F_CPU / 8 / TRACE_BAUD) - 1;      /* 16 → 117.6 kBd;
+                                                   F_CPU: .cproj     */
+    UCSR0A = _BV(U2X0);
+    UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);         /* 8N1               */
+    UCSR0B = _BV(TXEN0);
+}
+
+void    trace_request_dump(void) { dump_req = 1; }
+uint8_t trace_dump_due(void)     { return dump_req; }
+
+static void uart_put(uint8_t b)
+{
+    while (!(UCSR0A & _BV(UDRE0))) ;
+    UDR0 = b;
+}
+
+/* [type][tick:4 = 0][payload], COBS-encoded, 0x00-terminated */
+static void send_record(const uint8_t *p, uint8_t len)
+{
+    uint8_t b[5 + 12] = { TRACE_RECORD };
+    memcpy(b + 5, p, len);
+    const uint8_t n = 5 + len;
+
+    uint8_t start = 0;
+    for (uint8_t i = 0; i <= n; i++) {
+        if (i == n || !b[i]) {
+            uart_put(i - start + 1);
+            while (start < i) uart_put(b[start++]);
+            start = i + 1;
+        }
+    }
+    uart_put(0x00);
+}
+
+void trace_dump(void)
+{
+    uint8_t head;
+
+    TRACE(TR_UNO_DUMP, 0);
+    cli();
+    head     = trace_head;
+    dump_req = 0;
+    sei();
+
+    send_record(0, 0);
+    uint8_t p[12], n = 0;
+    uint8_t i = head;
+    do {
+        cli();
+        const trace_ev_t e = trace_buf[i];
+        sei();
+        if (!e.id) continue;                    /* never written     */
+        p[n++] = e.id;
+        p[n++] = e.v;
+        p[n++] = e.t;
+        if (n == sizeof p) { send_record(p, n); n = 0; }
+    } while (++i != head);
+    if (n) send_record(p, n);
+}
+
+#elif TRACE_ENABLE == 2
+
+void trace_init(void)
+{
+    TRACE_DDR |= _BV(TRACE_PIN);
+}
+
+#endif
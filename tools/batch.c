@@ -0,0 +1,349 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : batch.c   — batch kernels: scalar, SSE4.1, AVX2 (batch.h)
+ * Licence  : MIT
+ *
+ * Cars never interact, so every kernel takes one group of lanes
+ * through all the ticks asked for before it moves on to the next:
+ * the group's state stays in registers, not just in cache.  The
+ * result is the same as stepping every car one tick at a time.
+ *
+ * On most ticks nothing is due (a floor is 25 ticks, the door 500),
+ * so the vector kernels test the whole group with one compare and
+ * only then work out the transitions, with masks instead of the
+ * scalar switch.  The ISA kernels are compiled with target
+ * attributes and picked at run time, so CFLAGS need no -mavx2.
+ ***********************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BATCH_X86 1
+#endif
+
+#include "batch.h"
+
+#define K_TICKS   (BATCH_KEY_MS   / BATCH_TICK_MS)
+#define F_TICKS   (FLOOR_TIME_MS  / BATCH_TICK_MS)
+#define O_TICKS   (DOOR_OPEN_MS   / BATCH_TICK_MS)
+#define C_TICKS   (DOOR_CLOSED_MS / BATCH_TICK_MS)
+
+/* splitmix64: per-car seeds from one seed */
+static uint64_t splitmix(uint64_t *s)
+{
+    uint64_t z = (*s += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint32_t batch_rnd(uint32_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+/* Multiply-shift, not %, so that the vector kernels can do it too */
+int32_t batch_floor(uint32_t x, int32_t floors)
+{
+    return (int32_t)(((x >> 16) * (uint32_t)floors) >> 16);
+}
+
+int batch_init(batch_t *b, size_t n, unsigned floors, uint64_t seed,
+               double emg_share, uint32_t horizon)
+{
+    memset(b, 0, sizeof *b);
+    b->n      = n;
+    b->lanes  = (n + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+    b->floors = (int32_t)floors;
+
+    int32_t *mem = calloc(8 * b->lanes, sizeof *mem);
+    if (!mem) return -1;
+    b->cur      = mem;
+    b->tgt      = mem + 1 * b->lanes;
+    b->phase    = mem + 2 * b->lanes;
+    b->timer    = mem + 3 * b->lanes;
+    b->latch    = mem + 4 * b->lanes;
+    b->emg_tick = mem + 5 * b->lanes;
+    b->trips    = mem + 6 * b->lanes;
+    b->rng      = (uint32_t *)(mem + 7 * b->lanes);
+
+    uint64_t s = seed;
+    for (size_t i = 0; i < b->lanes; i++) {
+        b->phase[i] = PH_THINK;
+        b->timer[i] = 2 * K_TICKS;
+        b->rng[i]   = (uint32_t)splitmix(&s);
+        if (!b->rng[i]) b->rng[i] = 1;
+        if ((splitmix(&s) >> 11) * 0x1.0p-53 < emg_share && horizon)
+            b->emg_tick[i] = (int32_t)(1 + splitmix(&s) % horizon);
+    }
+    return 0;
+}
+
+void batch_free(batch_t *b)
+{
+    free(b->cur);
+    memset(b, 0, sizeof *b);
+}
+
+state_t batch_state(const batch_t *b, size_t i)
+{
+    switch (b->phase[i]) {
+    case PH_THINK:  return ST_IDLE;
+    case PH_MOVE:   return ST_MOVING;
+    case PH_OPEN:
+    case PH_CLOSED: return ST_DOOR;
+    default:        return ST_EMERGENCY;
+    }
+}
+
+/*----------------------------------------------------------------------
+  Scalar: elevator.c's switch, one car at a time
+  --------------------------------------------------------------------*/
+static void run_scalar(batch_t *b, uint32_t ticks)
+{
+    const int32_t floors = b->floors;
+
+    for (size_t i = 0; i < b->lanes; i++) {
+        int32_t  cur = b->cur[i], tgt = b->tgt[i], phase = b->phase[i];
+        int32_t  timer = b->timer[i], latch = b->latch[i], trips = b->trips[i];
+        uint32_t rng = b->rng[i];
+        const int32_t emg = b->emg_tick[i];
+
+        for (uint32_t t = b->tick + 1; t <= b->tick + ticks; t++) {
+            if ((int32_t)t == emg) latch = 1;
+            if (--timer) continue;
+
+            switch (phase) {
+            case PH_THINK:
+                rng = batch_rnd(rng);
+                tgt = batch_floor(rng, floors);
+                if (tgt == cur) {                       /* FAULT */
+                    timer = 2 * K_TICKS;
+                    break;
+                }
+                phase = PH_MOVE;
+                /* fall through */
+            case PH_MOVE:
+                if (cur != tgt && !latch) {
+                    cur  += tgt > cur ? 1 : -1;
+                    timer = F_TICKS;
+                } else if (latch) {
+                    phase = PH_EMG_KEY; latch = 0; timer = K_TICKS;
+                } else {
+                    phase = PH_OPEN; timer = O_TICKS;
+                }
+                break;
+            case PH_OPEN:       phase = PH_CLOSED;      timer = C_TICKS; break;
+            case PH_EMG_KEY:    phase = PH_EMG_OPEN;    timer = O_TICKS; break;
+            case PH_EMG_OPEN:   phase = PH_EMG_CLOSED;  timer = C_TICKS; break;
+            case PH_CLOSED:
+            case PH_EMG_CLOSED: phase = PH_THINK; timer = 2 * K_TICKS; trips++; break;
+            }
+        }
+        b->cur[i]   = cur;   b->tgt[i]   = tgt;   b->phase[i] = phase;
+        b->timer[i] = timer; b->latch[i] = latch; b->trips[i] = trips;
+        b->rng[i]   = rng;
+    }
+    b->tick += ticks;
+}
+
+static int always(void) { return 1; }
+
+#if BATCH_X86
+/*----------------------------------------------------------------------
+  AVX2: 8 cars per instruction
+  --------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static void run_avx2(batch_t *b, uint32_t ticks)
+{
+    const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi32(1);
+    const __m256i down = _mm256_set1_epi32(-1), floors = _mm256_set1_epi32(b->floors);
+    const __m256i k2 = _mm256_set1_epi32(2 * K_TICKS), kk = _mm256_set1_epi32(K_TICKS);
+    const __m256i kf = _mm256_set1_epi32(F_TICKS),     ko = _mm256_set1_epi32(O_TICKS);
+    const __m256i kc = _mm256_set1_epi32(C_TICKS);
+    const __m256i p_think = _mm256_set1_epi32(PH_THINK),   p_move  = _mm256_set1_epi32(PH_MOVE);
+    const __m256i p_open  = _mm256_set1_epi32(PH_OPEN),    p_close = _mm256_set1_epi32(PH_CLOSED);
+    const __m256i p_ekey  = _mm256_set1_epi32(PH_EMG_KEY), p_eopen = _mm256_set1_epi32(PH_EMG_OPEN);
+    const __m256i p_eclose = _mm256_set1_epi32(PH_EMG_CLOSED);
+
+    for (size_t i = 0; i < b->lanes; i += 8) {
+        __m256i cur   = _mm256_loadu_si256((const __m256i *)(b->cur + i));
+        __m256i tgt   = _mm256_loadu_si256((const __m256i *)(b->tgt + i));
+        __m256i phase = _mm256_loadu_si256((const __m256i *)(b->phase + i));
+        __m256i timer = _mm256_loadu_si256((const __m256i *)(b->timer + i));
+        __m256i trips = _mm256_loadu_si256((const __m256i *)(b->trips + i));
+        __m256i rng   = _mm256_loadu_si256((const __m256i *)(b->rng + i));
+        const __m256i emg = _mm256_loadu_si256((const __m256i *)(b->emg_tick + i));
+        __m256i latch = _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)(b->latch + i)), zero);
+
+        for (uint32_t t = b->tick + 1; t <= b->tick + ticks; t++) {
+            latch = _mm256_or_si256(latch, _mm256_cmpeq_epi32(emg, _mm256_set1_epi32((int32_t)t)));
+            timer = _mm256_sub_epi32(timer, one);
+            const __m256i due = _mm256_cmpeq_epi32(timer, zero);
+            if (!_mm256_movemask_epi8(due)) continue;
+
+            const __m256i ph = phase;
+
+            /* THINK: draw the floor; the same one is a FAULT */
+            const __m256i think = _mm256_and_si256(due, _mm256_cmpeq_epi32(ph, p_think));
+            __m256i x = rng;
+            x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+            x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+            x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+            rng = _mm256_blendv_epi8(rng, x, think);
+            tgt = _mm256_blendv_epi8(tgt, _mm256_srli_epi32(
+                      _mm256_mullo_epi32(_mm256_srli_epi32(rng, 16), floors), 16), think);
+            const __m256i fault = _mm256_and_si256(think, _mm256_cmpeq_epi32(tgt, cur));
+            const __m256i start = _mm256_andnot_si256(fault, think);
+            timer = _mm256_blendv_epi8(timer, k2, fault);
+            phase = _mm256_blendv_epi8(phase, p_move, start);
+
+            /* MOVE: next floor, or stop for the door or the emergency */
+            const __m256i check = _mm256_or_si256(start,
+                                      _mm256_and_si256(due, _mm256_cmpeq_epi32(ph, p_move)));
+            const __m256i go    = _mm256_andnot_si256(latch,
+                                      _mm256_andnot_si256(_mm256_cmpeq_epi32(cur, tgt), check));
+            const __m256i dir   = _mm256_blendv_epi8(down, one, _mm256_cmpgt_epi32(tgt, cur));
+            cur   = _mm256_add_epi32(cur, _mm256_and_si256(go, dir));
+            timer = _mm256_blendv_epi8(timer, kf, go);
+            const __m256i stop = _mm256_andnot_si256(go, check);
+            const __m256i alarm = _mm256_and_si256(stop, latch);
+            const __m256i door  = _mm256_andnot_si256(latch, stop);
+            phase = _mm256_blendv_epi8(phase, p_ekey, alarm);
+            timer = _mm256_blendv_epi8(timer, kk, alarm);
+            latch = _mm256_andnot_si256(alarm, latch);
+            phase = _mm256_blendv_epi8(phase, p_open, door);
+            timer = _mm256_blendv_epi8(timer, ko, door);
+
+            /* Door and emergency phases: on to the next one */
+            const __m256i is_open  = _mm256_or_si256(_mm256_cmpeq_epi32(ph, p_open),
+                                                     _mm256_cmpeq_epi32(ph, p_eopen));
+            const __m256i is_ekey  = _mm256_cmpeq_epi32(ph, p_ekey);
+            const __m256i is_close = _mm256_or_si256(_mm256_cmpeq_epi32(ph, p_close),
+                                                     _mm256_cmpeq_epi32(ph, p_eclose));
+            const __m256i to_close = _mm256_and_si256(due, is_open);
+            const __m256i to_eopen = _mm256_and_si256(due, is_ekey);
+            const __m256i back     = _mm256_and_si256(due, is_close);
+            phase = _mm256_sub_epi32(phase, _mm256_or_si256(to_close, to_eopen));    /* +1 */
+            timer = _mm256_blendv_epi8(timer, kc, to_close);
+            timer = _mm256_blendv_epi8(timer, ko, to_eopen);
+            phase = _mm256_blendv_epi8(phase, p_think, back);
+            timer = _mm256_blendv_epi8(timer, k2, back);
+            trips = _mm256_sub_epi32(trips, back);                                    /* +1 */
+        }
+        _mm256_storeu_si256((__m256i *)(b->cur + i),   cur);
+        _mm256_storeu_si256((__m256i *)(b->tgt + i),   tgt);
+        _mm256_storeu_si256((__m256i *)(b->phase + i), phase);
+        _mm256_storeu_si256((__m256i *)(b->timer + i), timer);
+        _mm256_storeu_si256((__m256i *)(b->trips + i), trips);
+        _mm256_storeu_si256((__m256i *)(b->rng + i),   rng);
+        _mm256_storeu_si256((__m256i *)(b->latch + i), _mm256_and_si256(latch, one));
+    }
+    b->tick += ticks;
+}
+
+/*----------------------------------------------------------------------
+  SSE4.1: the same, 4 cars per instruction
+  --------------------------------------------------------------------*/
+__attribute__((target("sse4.1")))
+static void run_sse41(batch_t *b, uint32_t ticks)
+{
+    const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi32(1);
+    const __m128i down = _mm_set1_epi32(-1), floors = _mm_set1_epi32(b->floors);
+    const __m128i k2 = _mm_set1_epi32(2 * K_TICKS), kk = _mm_set1_epi32(K_TICKS);
+    const __m128i kf = _mm_set1_epi32(F_TICKS),     ko = _mm_set1_epi32(O_TICKS);
+    const __m128i kc = _mm_set1_epi32(C_TICKS);
+    const __m128i p_think = _mm_set1_epi32(PH_THINK),   p_move  = _mm_set1_epi32(PH_MOVE);
+    const __m128i p_open  = _mm_set1_epi32(PH_OPEN),    p_close = _mm_set1_epi32(PH_CLOSED);
+    const __m128i p_ekey  = _mm_set1_epi32(PH_EMG_KEY), p_eopen = _mm_set1_epi32(PH_EMG_OPEN);
+    const __m128i p_eclose = _mm_set1_epi32(PH_EMG_CLOSED);
+
+    for (size_t i = 0; i < b->lanes; i += 4) {
+        __m128i cur   = _mm_loadu_si128((const __m128i *)(b->cur + i));
+        __m128i tgt   = _mm_loadu_si128((const __m128i *)(b->tgt + i));
+        __m128i phase = _mm_loadu_si128((const __m128i *)(b->phase + i));
+        __m128i timer = _mm_loadu_si128((const __m128i *)(b->timer + i));
+        __m128i trips = _mm_loadu_si128((const __m128i *)(b->trips + i));
+        __m128i rng   = _mm_loadu_si128((const __m128i *)(b->rng + i));
+        const __m128i emg = _mm_loadu_si128((const __m128i *)(b->emg_tick + i));
+        __m128i latch = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i *)(b->latch + i)), zero);
+
+        for (uint32_t t = b->tick + 1; t <= b->tick + ticks; t++) {
+            latch = _mm_or_si128(latch, _mm_cmpeq_epi32(emg, _mm_set1_epi32((int32_t)t)));
+            timer = _mm_sub_epi32(timer, one);
+            const __m128i due = _mm_cmpeq_epi32(timer, zero);
+            if (!_mm_movemask_epi8(due)) continue;
+
+            const __m128i ph = phase;
+
+            const __m128i think = _mm_and_si128(due, _mm_cmpeq_epi32(ph, p_think));
+            __m128i x = rng;
+            x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+            x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+            x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+            rng = _mm_blendv_epi8(rng, x, think);
+            tgt = _mm_blendv_epi8(tgt, _mm_srli_epi32(
+                      _mm_mullo_epi32(_mm_srli_epi32(rng, 16), floors), 16), think);
+            const __m128i fault = _mm_and_si128(think, _mm_cmpeq_epi32(tgt, cur));
+            const __m128i start = _mm_andnot_si128(fault, think);
+            timer = _mm_blendv_epi8(timer, k2, fault);
+            phase = _mm_blendv_epi8(phase, p_move, start);
+
+            const __m128i check = _mm_or_si128(start,
+                                      _mm_and_si128(due, _mm_cmpeq_epi32(ph, p_move)));
+            const __m128i go    = _mm_andnot_si128(latch,
+                                      _mm_andnot_si128(_mm_cmpeq_epi32(cur, tgt), check));
+            const __m128i dir   = _mm_blendv_epi8(down, one, _mm_cmpgt_epi32(tgt, cur));
+            cur   = _mm_add_epi32(cur, _mm_and_si128(go, dir));
+            timer = _mm_blendv_epi8(timer, kf, go);
+            const __m128i stop = _mm_andnot_si128(go, check);
+            const __m128i alarm = _mm_and_si128(stop, latch);
+            const __m128i door  = _mm_andnot_si128(latch, stop);
+            phase = _mm_blendv_epi8(phase, p_ekey, alarm);
+            timer = _mm_blendv_epi8(timer, kk, alarm);
+            latch = _mm_andnot_si128(alarm, latch);
+            phase = _mm_blendv_epi8(phase, p_open, door);
+            timer = _mm_blendv_epi8(timer, ko, door);
+
+            const __m128i is_open  = _mm_or_si128(_mm_cmpeq_epi32(ph, p_open),
+                                                  _mm_cmpeq_epi32(ph, p_eopen));
+            const __m128i is_ekey  = _mm_cmpeq_epi32(ph, p_ekey);
+            const __m128i is_close = _mm_or_si128(_mm_cmpeq_epi32(ph, p_close),
+                                                  _mm_cmpeq_epi32(ph, p_eclose));
+            const __m128i to_close = _mm_and_si128(due, is_open);
+            const __m128i to_eopen = _mm_and_si128(due, is_ekey);
+            const __m128i back     = _mm_and_si128(due, is_close);
+            phase = _mm_sub_epi32(phase, _mm_or_si128(to_close, to_eopen));
+            timer = _mm_blendv_epi8(timer, kc, to_close);
+            timer = _mm_blendv_epi8(timer, ko, to_eopen);
+            phase = _mm_blendv_epi8(phase, p_think, back);
+            timer = _mm_blendv_epi8(timer, k2, back);
+            trips = _mm_sub_epi32(trips, back);
+        }
+        _mm_storeu_si128((__m128i *)(b->cur + i),   cur);
+        _mm_storeu_si128((__m128i *)(b->tgt + i),   tgt);
+        _mm_storeu_si128((__m128i *)(b->phase + i), phase);
+        _mm_storeu_si128((__m128i *)(b->timer + i), timer);
+        _mm_storeu_si128((__m128i *)(b->trips + i), trips);
+        _mm_storeu_si128((__m128i *)(b->rng + i),   rng);
+        _mm_storeu_si128((__m128i *)(b->latch + i), _mm_and_si128(latch, one));
+    }
+    b->tick += ticks;
+}
+
+static int have_avx2(void)  { return __builtin_cpu_supports("avx2"); }
+static int have_sse41(void) { return __builtin_cpu_supports("sse4.1"); }
+#endif
+
+const batch_kernel_t batch_kernels[] = {
+    { "scalar", run_scalar, always     },
+#if BATCH_X86
+    { "sse4.1", run_sse41,  have_sse41 },
+    { "avx2",   run_avx2,   have_avx2  },
+#endif
+    { 0, 0, 0 }
+};
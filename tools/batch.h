@@ -0,0 +1,71 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : batch.h   — thousands of cars at once, structure of arrays
+ * Licence  : MIT
+ *
+ * For Monte-Carlo studies: n independent cars, each with a passenger
+ * typing a random floor every time it is idle and, for a share of the
+ * cars, one emergency press at a random moment.  The controller is
+ * elevator.c's FSM re-expressed on the board's 10 ms tick, so that
+ * all cars advance together:
+ *
+ *   THINK       two keys, KEY_TICKS each; same floor = FAULT, again
+ *   MOVE        a floor per FLOOR_TIME_MS; stops at the target or,
+ *               with the emergency latched, where it is
+ *   OPEN/CLOSED DOOR_OPEN_MS, DOOR_CLOSED_MS, then THINK (one trip)
+ *   EMG_*       '#' after KEY_TICKS, then the door as above
+ *
+ * The latch is checked where elevator.c checks it: before each floor
+ * and on arrival.  Each car is one lane of every array; the kernels
+ * differ only in how many lanes they step per instruction, and give
+ * identical arrays.  tools/batchsim checks them against elevator.c
+ * on the fake HAL and measures car-ticks per second.
+ ***********************************************************************/
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "elevator.h"
+
+#define BATCH_TICK_MS     10
+#define BATCH_KEY_MS      300          /* per key typed, as traffic  */
+#define BATCH_LANES       8            /* n is padded to this        */
+
+enum { PH_THINK, PH_MOVE, PH_OPEN, PH_CLOSED,
+       PH_EMG_KEY, PH_EMG_OPEN, PH_EMG_CLOSED };
+
+typedef struct {
+    size_t    n, lanes;                /* cars; lanes = n padded     */
+    int32_t   floors;                  /* 2..100                     */
+    uint32_t  tick;                    /* ticks run so far           */
+
+    /* one entry per lane */
+    int32_t  *cur, *tgt;               /* as elevator_t              */
+    int32_t  *phase, *timer;           /* PH_*; ticks to its end     */
+    int32_t  *latch, *emg_tick;        /* 0/1; press tick, 0 = none  */
+    int32_t  *trips;                   /* returns to IDLE            */
+    uint32_t *rng;                     /* xorshift32, never 0        */
+} batch_t;
+
+typedef void (*batch_kernel_fn)(batch_t *b, uint32_t ticks);
+
+typedef struct {
+    const char     *name;
+    batch_kernel_fn run;
+    int           (*usable)(void);     /* this CPU has the ISA       */
+} batch_kernel_t;
+
+extern const batch_kernel_t batch_kernels[];   /* scalar first; 0-ended */
+
+/* Same cars for the same seed; emg_share of them get one press in
+   the first *horizon* ticks.  0 = ok, -1 = out of memory.          */
+int      batch_init(batch_t *b, size_t n, unsigned floors, uint64_t seed,
+                    double emg_share, uint32_t horizon);
+void     batch_free(batch_t *b);
+
+uint32_t batch_rnd(uint32_t x);        /* next xorshift32 state      */
+int32_t  batch_floor(uint32_t x, int32_t floors);   /* draw → floor */
+state_t  batch_state(const batch_t *b, size_t i);
+
+#endif /* BATCH_H */
@@ -0,0 +1,232 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : batchsim.c   — many cars at once: check and throughput
+ * Purpose  : Run the batch kernels (batch.h) on the same cars, check
+ *            that they agree with each other and with elevator.c on
+ *            the fake HAL, and report car-ticks per second.
+ * Licence  : MIT
+ *
+ *   batchsim [-n cars] [-T seconds] [-f floors] [-e share] [-S seed]
+ *            [-c check] [-k kernel]
+ *
+ *   -n   cars (default 4096)
+ *   -T   simulated time in seconds (default 600; 100 ticks each)
+ *   -f   floors, lobby = 0 (2..100, default 10)
+ *   -e   share of the cars with an emergency press (default 0.25)
+ *   -c   cars to replay through elevator.c (default 256, 0 = none)
+ *   -k   scalar, sse4.1 or avx2 only (default: every one this CPU has)
+ *
+ * Every kernel must leave the same arrays as the scalar one.  For the
+ * first -c cars, elevator.c then runs on hal_sim with the same keys
+ * and presses, and the floor, target, state and trip count must match
+ * after -T.  The user of the reference presses each key on a tick,
+ * as the board's keypad scan would see it; everything else the FSM
+ * does between two waits takes less than a tick on the fake HAL.
+ *
+ * Exit status 1 if anything differs.
+ ***********************************************************************/
+#define _POSIX_C_SOURCE 199309L
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "elevator.h"
+#include "hal.h"
+#include "hal_sim.h"
+#include "telemetry.h"
+
+#define TICK_US  (BATCH_TICK_MS * 1000ULL)
+
+static const char *const state_names[] = { "IDLE", "MOVING", "DOOR", "EMERGENCY" };
+
+static double wall_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*----------------------------------------------------------------------
+  Reference: one car through elevator.c
+  --------------------------------------------------------------------*/
+typedef struct {
+    uint32_t   rng;
+    int32_t    floors;
+    char       pending[2];
+    uint8_t    n_pending;
+    int32_t    trips;
+    elevator_t lift;
+    jmp_buf    stop;
+} ref_t;
+
+/* Same draws as the kernels; the key lands KEY_MS later, on a tick */
+static char ref_key(void *ctx, uint32_t *think_ms)
+{
+    ref_t *r = ctx;
+    const uint64_t at = (sim.now_us / TICK_US + BATCH_KEY_MS / BATCH_TICK_MS) * TICK_US;
+    *think_ms = (uint32_t)((at - sim.now_us + 999) / 1000);
+
+    if (strncmp(sim.lcd[1], "Press #", 7) == 0)
+        return '#';
+    if (!r->n_pending) {
+        r->rng = batch_rnd(r->rng);
+        const int32_t f = batch_floor(r->rng, r->floors);
+        r->pending[1] = (char)('0' + f / 10);
+        r->pending[0] = (char)('0' + f % 10);
+        r->n_pending  = 2;
+    }
+    return r->pending[--r->n_pending];
+}
+
+static void ref_tlm(void *ctx, uint8_t type, const uint8_t *p, uint8_t len)
+{
+    ref_t *r = ctx;
+    (void)len;
+    if (type == TLM_STATE && p[1] == ST_IDLE) r->trips++;
+}
+
+static void press(void *ctx, uint64_t arg)
+{
+    (void)ctx; (void)arg;
+    sim_emg_press();
+}
+
+static void stop(void *ctx, uint64_t arg)
+{
+    ref_t *r = ctx;
+    (void)arg;
+    longjmp(r->stop, 1);
+}
+
+static void run_fsm(ref_t *r)
+{
+    if (!setjmp(r->stop))
+        for (;;) elevator_step(&r->lift);
+}
+
+/* Car *i* of a fresh batch, for *ticks*: everything the tick at the
+   end starts has happened, nothing of the next one                */
+static void ref_run(ref_t *r, const batch_t *fresh, size_t i, uint32_t ticks)
+{
+    memset(r, 0, sizeof *r);
+    r->rng    = fresh->rng[i];
+    r->floors = fresh->floors;
+
+    sim_reset(ref_key, ref_tlm, r);
+    if (fresh->emg_tick[i]) sim_at((uint64_t)fresh->emg_tick[i] * TICK_US, press, 0);
+    sim_at((uint64_t)(ticks + 1) * TICK_US - 1, stop, 0);
+    hal_init();
+    tlm_init();
+    elevator_init(&r->lift);
+    run_fsm(r);
+}
+
+/* All eight arrays are one block, starting at cur */
+static int same_arrays(const batch_t *a, const batch_t *b)
+{
+    return !memcmp(a->cur, b->cur, 8 * a->lanes * sizeof *a->cur);
+}
+
+int main(int argc, char **argv)
+{
+    size_t   cars = 4096, check = 256;
+    double   seconds = 600, emg_share = 0.25;
+    unsigned floors = 10;
+    uint64_t seed = 1;
+    const char *only = 0;
+    int      opt, status = 0;
+
+    while ((opt = getopt(argc, argv, "n:T:f:e:S:c:k:")) != -1) {
+        switch (opt) {
+        case 'n': cars      = strtoul(optarg, 0, 0);    break;
+        case 'T': seconds   = atof(optarg);             break;
+        case 'f': floors    = (unsigned)atoi(optarg);   break;
+        case 'e': emg_share = atof(optarg);             break;
+        case 'S': seed      = strtoull(optarg, 0, 0);   break;
+        case 'c': check     = strtoul(optarg, 0, 0);    break;
+        case 'k': only      = optarg;                   break;
+        default:  goto usage;
+        }
+    }
+    const uint32_t ticks = (uint32_t)(seconds * 1000 / BATCH_TICK_MS);
+    if (optind != argc || !cars || !ticks || floors < 2 || floors > 100 ||
+        emg_share < 0 || emg_share > 1)
+        goto usage;
+    if (check > cars) check = cars;
+
+    printf("%zu cars, %u floors, %.0f s = %u ticks, %.0f %% with an emergency\n",
+           cars, floors, seconds, ticks, emg_share * 100);
+    printf("%-8s %9s %14s %8s  %s\n", "kernel", "wall s", "car-ticks/s", "speed-up", "arrays");
+
+    batch_t ref, b;
+    double  scalar_rate = 0;
+
+    /* The scalar kernel always runs first: it is what the others match */
+    for (const batch_kernel_t *k = batch_kernels; k->name; k++) {
+        if (only && strcmp(only, k->name) && k != batch_kernels) continue;
+        if (!k->usable()) {
+            printf("%-8s %9s\n", k->name, "(no CPU support)");
+            continue;
+        }
+        if (batch_init(&b, cars, floors, seed, emg_share, ticks)) goto oom;
+        const double t0 = wall_s();
+        k->run(&b, ticks);
+        const double wall = wall_s() - t0;
+        const double rate = (double)cars * ticks / wall;
+        if (k == batch_kernels) {
+            scalar_rate = rate;
+            ref = b;
+        }
+        const int same = same_arrays(&ref, &b);
+        printf("%-8s %9.3f %14.3e %7.1fx  %s\n", k->name, wall, rate, rate / scalar_rate,
+               same ? "same as scalar" : "DIFFER");
+        if (!same) status = 1;
+        if (k != batch_kernels) batch_free(&b);
+    }
+
+    /* The scalar arrays against elevator.c, car by car */
+    if (check) {
+        batch_t fresh;
+        long    trips = 0, emgs = 0;
+        if (batch_init(&fresh, cars, floors, seed, emg_share, ticks)) goto oom;
+        for (size_t i = 0; i < check; i++) {
+            static ref_t r;
+            ref_run(&r, &fresh, i, ticks);
+            const state_t st = batch_state(&ref, i);
+            if (r.lift.current_floor != ref.cur[i] || r.lift.target_floor != ref.tgt[i] ||
+                r.lift.state != st || r.trips != ref.trips[i]) {
+                printf("car %zu differs from elevator.c:\n"
+                       "  batch     floor %d  target %d  %-9s  %d trips\n"
+                       "  elevator  floor %d  target %d  %-9s  %d trips\n",
+                       i, ref.cur[i], ref.tgt[i], state_names[st], ref.trips[i],
+                       r.lift.current_floor, r.lift.target_floor, state_names[r.lift.state],
+                       r.trips);
+                status = 1;
+                break;
+            }
+            trips += r.trips;
+            emgs  += fresh.emg_tick[i] != 0;
+            if (i == check - 1)
+                printf("elevator.c: first %zu cars identical (%ld trips, %ld emergencies)\n",
+                       check, trips, emgs);
+        }
+        batch_free(&fresh);
+    }
+    batch_free(&ref);
+    return status;
+
+oom:
+    fprintf(stderr, "batchsim: out of memory\n");
+    return 2;
+
+usage:
+    fprintf(stderr, "usage: %s [-n cars] [-T seconds] [-f floors] [-e share] [-S seed]\n"
+                    "       %*s [-c check] [-k scalar|sse4.1|avx2]\n",
+            argv[0], (int)strlen(argv[0]), "");
+    return 2;
+}
@@ -0,0 +1,76 @@
+/*************************************************************
+ * bench.h  — markers for the cycle benchmarks (AVR side)
+ *
+ * A bench image brackets each measured call with BENCH_START()
+ * and BENCH_STOP().  The markers are single OUT instructions to
+ * the general-purpose I/O registers, which simbench watches:
+ *
+ *   GPIOR0   1 = start, 2 = stop, 0xFF = image finished
+ *   GPIOR1   name of the following case, one char per write,
+ *            terminated by 0
+ *   GPIOR2   stimulus for the runner's pin models: the keypad key
+ *            on the MEGA, a byte from the SPI master on the UNO
+ *            (see simbench.c)
+ *
+ * The first case of every image is "overhead": an empty
+ * START/STOP pair, which simbench subtracts from all others.
+ *
+ * ISRs are entered with BENCH_ISR(vector), a CALL to the vector
+ * function followed by CLI: the instruction after RETI always
+ * runs before a pending interrupt, so nothing else is timed.  The
+ * figure therefore counts CALL (4 cycles, 5 on the 2560) + body +
+ * RETI + CLI; the hardware entry it stands for is 4 cycles + the
+ * 3-cycle JMP in the vector table (5 + 3 on the 2560).
+ *************************************************************/
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#define BENCH_STR_(x)     #x
+#define BENCH_STR(x)      BENCH_STR_(x)
+
+#define BENCH_START()     do { GPIOR0 = 1; } while (0)
+#define BENCH_STOP()      do { GPIOR0 = 2; } while (0)
+#define BENCH_STIM(v)     do { GPIOR2 = (v); } while (0)
+
+/* Enter an ISR in software, untimed or timed.  RETI sets I again;
+   the images run with interrupts off, so CLI must come next.     */
+#define BENCH_CALL(vect)  do {                                  \
+        __asm__ __volatile__ ("call " BENCH_STR(vect) ::: "memory"); \
+        cli();                                                  \
+    } while (0)
+
+#define BENCH_ISR(vect)   do {                                  \
+        BENCH_START();                                          \
+        __asm__ __volatile__ ("call " BENCH_STR(vect) ::: "memory"); \
+        cli();                                                  \
+        BENCH_STOP();                                           \
+    } while (0)
+
+/* Time one expression or statement */
+#define BENCH(stmt)       do { BENCH_START(); stmt; BENCH_STOP(); } while (0)
+
+static inline void bench_case(const char *name)
+{
+    while (*name) GPIOR1 = *name++;
+    GPIOR1 = 0;
+}
+
+/* Calibration, then the image's own cases; never returns */
+static inline void bench_begin(void)
+{
+    cli();
+    bench_case("overhead");
+    for (uint8_t i = 0; i < 8; i++) BENCH(;);
+}
+
+static inline void bench_end(void)
+{
+    GPIOR0 = 0xFF;
+    cli();
+    for (;;) __asm__ __volatile__ ("sleep");
+}
+
+#endif /* BENCH_H */
@@ -0,0 +1,394 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : cosim.c   — MEGA + UNO co-simulation under simavr
+ * Purpose  : Run both firmware images in lock-step with their SPI pins
+ *            connected, drive the keypad and the emergency button from
+ *            a script and time what the passenger sees on the UNO.
+ * Licence  : MIT
+ *
+ *   cosim [-s script | -r trips] [-e emergency%] [-S seed] [-j] [-v]
+ *         mega.elf uno.elf
+ *
+ *   -s   event script, one event per line ('#' starts a comment):
+ *            <ms>  key <c>       press <c> for KEY_HOLD_MS
+ *            <ms>  emg           press the emergency button
+ *   -r   generate <trips> random trips instead (default 20)
+ *   -e   chance of an emergency during a generated trip (default 25)
+ *   -S   random seed (default 1)
+ *   -j   print the distributions as JSON lines instead of a table
+ *   -v   print every measured sample
+ *
+ * The UNO image must be built with AUDIO_PROFILE=1 (see the Makefile):
+ * PD4 falls when the arbiter has started the requested sound, which
+ * stays unambiguous while a chime is already sounding on PD3.
+ *
+ * Measured, from the passenger's point of view:
+ *   key_to_led   last key press → movement LED (UNO PB0) on
+ *   emg_to_sound button press   → emergency melody running (UNO PD4 ↓)
+ * each split at the moment the opcode crosses the SPI link into the
+ * MEGA's share (keypad debounce + scan, LCD, telemetry, SPI) and the
+ * UNO's (SPI ISR to pin).  And once, from power-on of both boards:
+ *   boot         → the last character of "Choose floor:" on the LCD
+ *                  bus, and → the first STATUS_READY reply (hal_avr.c)
+ ***********************************************************************/
+#define _DEFAULT_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sim_avr.h>
+#include <sim_elf.h>
+#include <sim_io.h>
+#include <sim_cycle_timers.h>
+#include <avr_ioport.h>
+#include <avr_spi.h>
+
+#include "models.h"
+#include "protocol.h"
+
+#define F_CPU          16000000UL
+#define CYC_PER_US     (F_CPU / 1000000UL)
+#define MS(ms)         ((uint64_t)(ms) * (F_CPU / 1000UL))
+
+#define KEY_HOLD_MS    80
+#define EMG_HOLD_MS    50
+#define SLEEP_STEP     CYC_PER_US      /* cap on a sleeping core's jump */
+#define REG_SPDR       0x4E            /* data space, both parts    */
+
+/* MEGA ports of the LCD (lcd.h, lcd_definitions.h), data space */
+#define REG_PORTA      0x22            /* RW  PA0                   */
+#define REG_PORTE      0x2E            /* D4  PE5, D6 PE3           */
+#define REG_PORTG      0x34            /* D5  PG5                   */
+#define REG_PORTH      0x102           /* D7  PH3, RS PH6           */
+#define PROMPT         "Choose floor:"
+
+#define MAX_EVENTS     4096
+#define MAX_SAMPLES    4096
+
+typedef struct {
+    uint64_t at;                       /* MEGA cycles                */
+    char     kind;                     /* 'k' key, 'e' emergency     */
+    char     key;
+} event_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    n;
+    uint64_t    total[MAX_SAMPLES], mega[MAX_SAMPLES], uno[MAX_SAMPLES];
+} metric_t;
+
+static avr_t    *mega, *uno;
+static event_t   ev[MAX_EVENTS];
+static int       n_ev;
+static int       verbose;
+
+static metric_t  key_to_led   = { .name = "key_to_led"   };
+static metric_t  emg_to_sound = { .name = "emg_to_sound" };
+
+/* Measurement state: stamps in each core's own cycles (lock-step
+   keeps the two within SLEEP_STEP of each other)                  */
+static uint64_t  t_key, t_led_cmd;
+static uint64_t  t_emg, t_emg_cmd;
+static uint64_t  t_prompt, t_uno_ready;
+
+static void sample(metric_t *m, uint64_t t0, uint64_t t_cmd, uint64_t t1)
+{
+    if (m->n == MAX_SAMPLES) return;
+    m->total[m->n] = t1 - t0;
+    m->mega [m->n] = t_cmd - t0;
+    m->uno  [m->n] = t1 - t_cmd;
+    if (verbose)
+        printf("%10.3f s  %-12s %8.1f us  (MEGA %.1f + UNO %.1f)\n",
+               (double)t1 / F_CPU, m->name,
+               (double)(t1 - t0) / CYC_PER_US,
+               (double)(t_cmd - t0) / CYC_PER_US, (double)(t1 - t_cmd) / CYC_PER_US);
+    m->n++;
+}
+
+/* --- SPI link ------------------------------------------------------- */
+/* The master finished a byte: it reads what the UNO left in SPDR (the
+   reply to the previous byte), and the UNO receives the new one.   */
+static void on_mega_spi(avr_irq_t *irq, uint32_t value, void *param)
+{
+    (void)irq; (void)param;
+    const uint8_t reply = uno->data[REG_SPDR];
+    avr_raise_irq(avr_io_getirq(mega, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_INPUT), reply);
+    avr_raise_irq(avr_io_getirq(uno,  AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_INPUT), value);
+
+    if (!t_uno_ready && reply != 0xFF && (reply & STATUS_READY))
+        t_uno_ready = mega->cycle;
+    if (value == CMD_MOVEMENT_LED_ON && t_key && !t_led_cmd)
+        t_led_cmd = mega->cycle;
+    if (value == CMD_BUZZER_PLAY_ONESHOT && t_emg && !t_emg_cmd)
+        t_emg_cmd = mega->cycle;
+}
+
+static void on_mega_ss(avr_irq_t *irq, uint32_t value, void *param)
+{
+    (void)irq; (void)param;
+    avr_raise_irq(model_pin(uno, 'B', 2), value);
+}
+
+/* --- LCD bus -------------------------------------------------------- */
+/* The HD44780 latches on the falling edge of E.  4-bit writes come
+   in pairs, high nibble first; the single nibbles of the power-up
+   sequence all have RS low, so pairing starts over when RS rises.  */
+static void on_lcd_e(avr_irq_t *irq, uint32_t value, void *param)
+{
+    static int     rs = -1, half;
+    static uint8_t hi;
+    static char    text[sizeof PROMPT];  /* last characters written  */
+    (void)irq; (void)param;
+
+    const uint8_t *d = mega->data;
+    if (value || (d[REG_PORTA] & 0x01) || t_prompt) return;  /* rise, read, done */
+
+    const int r = (d[REG_PORTH] >> 6) & 1;
+    const uint8_t nib = ((d[REG_PORTE] >> 5) & 1)      | ((d[REG_PORTG] >> 5) & 1) << 1 |
+                        ((d[REG_PORTE] >> 3) & 1) << 2 | ((d[REG_PORTH] >> 3) & 1) << 3;
+    if (r != rs) { rs = r; half = 0; }
+    if (!half++) { hi = nib; return; }
+    half = 0;
+    if (!rs) return;                   /* a command                */
+
+    memmove(text, text + 1, sizeof text - 2);
+    text[sizeof text - 2] = (char)(hi << 4 | nib);
+    if (!memcmp(text, PROMPT, sizeof text - 1))
+        t_prompt = mega->cycle;
+}
+
+/* --- UNO outputs ---------------------------------------------------- */
+static void on_uno_led(avr_irq_t *irq, uint32_t value, void *param)
+{
+    (void)irq; (void)param;
+    if (value && t_led_cmd) {
+        sample(&key_to_led, t_key, t_led_cmd, uno->cycle);
+        t_key = t_led_cmd = 0;
+    }
+}
+
+static void on_uno_profile(avr_irq_t *irq, uint32_t value, void *param)
+{
+    (void)irq; (void)param;
+    if (!value && t_emg_cmd) {
+        sample(&emg_to_sound, t_emg, t_emg_cmd, uno->cycle);
+        t_emg = t_emg_cmd = 0;
+    }
+}
+
+/* A sleeping core jumps to its next timer event; this timer keeps
+   it from running ahead of the other one.                          */
+static avr_cycle_count_t sleep_cap(avr_t *avr, avr_cycle_count_t when, void *param)
+{
+    (void)avr; (void)param;
+    return when + SLEEP_STEP;
+}
+
+/* --- inputs --------------------------------------------------------- */
+static void add_event(uint64_t at, char kind, char key)
+{
+    if (n_ev == MAX_EVENTS) { fprintf(stderr, "cosim: too many events\n"); exit(2); }
+    ev[n_ev++] = (event_t){ at, kind, key };
+}
+
+static void load_script(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); exit(2); }
+    char line[128];
+    int  ln = 0;
+    while (fgets(line, sizeof line, f)) {
+        ln++;
+        if (line[0] == '#') continue;       /* '#' is also a key   */
+        unsigned long ms;
+        char word[8], key = 0;
+        const int n = sscanf(line, "%lu %7s %c", &ms, word, &key);
+        if (n < 2) continue;
+        if (!strcmp(word, "key") && n == 3 && model_keypad_code(key))
+            add_event(MS(ms), 'k', key);
+        else if (!strcmp(word, "emg"))
+            add_event(MS(ms), 'e', 0);
+        else {
+            fprintf(stderr, "%s:%d: expected '<ms> key <c>' or '<ms> emg'\n", path, ln);
+            exit(2);
+        }
+    }
+    fclose(f);
+}
+
+static uint64_t rng;
+static uint32_t rnd(void)
+{
+    rng ^= rng >> 12; rng ^= rng << 25; rng ^= rng >> 27;
+    return (uint32_t)((rng * 2685821657736338717ULL) >> 32);
+}
+
+/* Trips spaced by the FSM's own timing (elevator.h) plus a margin */
+static void gen_trips(int trips, unsigned emg_pct)
+{
+    uint64_t t   = 1500;                       /* after boot, in ms */
+    int      cur = 0;
+    for (int i = 0; i < trips; i++) {
+        int f;
+        do f = (int)(rnd() % 100); while (f == cur);
+        add_event(MS(t),       'k', (char)('0' + f / 10));
+        add_event(MS(t + 300), 'k', (char)('0' + f % 10));
+        t += 300;
+        const uint32_t travel = (uint32_t)abs(f - cur) * 250;
+        if (rnd() % 100 < emg_pct) {
+            const uint32_t at = 50 + rnd() % travel;
+            add_event(MS(t + at), 'e', 0);
+            add_event(MS(t + at + 1500), 'k', '#');
+            t  += at + 1500;
+            cur = cur + (f > cur ? 1 : -1) * (int)((at + 249) / 250);
+        } else {
+            t  += travel;
+            cur = f;
+        }
+        t += 5000 + 1500 + 1000;                /* door cycle + margin */
+    }
+}
+
+/* --- distribution --------------------------------------------------- */
+static int cmp_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double pct(const uint64_t *v, uint32_t n, double p)
+{
+    return (double)v[(uint32_t)(p * (n - 1) + 0.5)] / CYC_PER_US;
+}
+
+static void report(metric_t *m, int json)
+{
+    static const char *const part[3] = { "", "_mega", "_uno" };
+    uint64_t *const  col[3]  = { m->total, m->mega, m->uno };
+
+    for (int k = 0; k < 3; k++) {
+        if (!m->n) {
+            if (!k) printf(json ? "{\"metric\":\"%s\",\"n\":0}\n" : "%-18s no samples\n", m->name);
+            continue;
+        }
+        qsort(col[k], m->n, sizeof col[k][0], cmp_u64);
+        const uint64_t *v = col[k];
+        if (json)
+            printf("{\"metric\":\"%s%s\",\"n\":%u,\"min_us\":%.1f,\"p50_us\":%.1f,"
+                   "\"p90_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}\n",
+                   m->name, part[k], m->n, pct(v, m->n, 0), pct(v, m->n, .5),
+                   pct(v, m->n, .9), pct(v, m->n, .99), pct(v, m->n, 1));
+        else
+            printf("%-12s%-6s %5u %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                   m->name, part[k], m->n, pct(v, m->n, 0), pct(v, m->n, .5),
+                   pct(v, m->n, .9), pct(v, m->n, .99), pct(v, m->n, 1));
+    }
+}
+
+/* --- main ----------------------------------------------------------- */
+static avr_t *load(const char *elf, const char *mcu)
+{
+    elf_firmware_t fw;
+    memset(&fw, 0, sizeof fw);
+    if (elf_read_firmware(elf, &fw)) { fprintf(stderr, "cosim: cannot read %s\n", elf); exit(2); }
+    avr_t *avr = avr_make_mcu_by_name(mcu);
+    if (!avr) { fprintf(stderr, "cosim: simavr lacks %s\n", mcu); exit(2); }
+    avr_init(avr);
+    avr->frequency = F_CPU;
+    avr_load_firmware(avr, &fw);
+    avr_cycle_timer_register(avr, SLEEP_STEP, sleep_cap, NULL);
+    return avr;
+}
+
+int main(int argc, char **argv)
+{
+    const char *script = 0;
+    int         trips = 20, json = 0, opt;
+    unsigned    emg_pct = 25;
+    uint64_t    seed = 1;
+
+    while ((opt = getopt(argc, argv, "s:r:e:S:jv")) != -1) {
+        switch (opt) {
+        case 's': script  = optarg;                      break;
+        case 'r': trips   = atoi(optarg);                break;
+        case 'e': emg_pct = (unsigned)atoi(optarg);      break;
+        case 'S': seed    = strtoull(optarg, 0, 0);      break;
+        case 'j': json    = 1;                           break;
+        case 'v': verbose = 1;                           break;
+        default:  goto usage;
+        }
+    }
+    if (optind != argc - 2) goto usage;
+    rng = seed ? seed : 1;
+
+    mega = load(argv[optind],     "atmega2560");
+    uno  = load(argv[optind + 1], "atmega328p");
+
+    model_lcd_ready(mega);
+    model_keypad_init(mega);
+    avr_raise_irq(model_pin(mega, 'E', 4), 1);          /* button up   */
+    avr_raise_irq(model_pin(uno,  'B', 2), 1);          /* SS idle     */
+
+    avr_irq_register_notify(avr_io_getirq(mega, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_OUTPUT),
+                            on_mega_spi, NULL);
+    avr_irq_register_notify(model_pin(mega, 'B', 0), on_mega_ss,     NULL);
+    avr_irq_register_notify(model_pin(mega, 'B', 5), on_lcd_e,       NULL);
+    avr_irq_register_notify(model_pin(uno,  'B', 0), on_uno_led,     NULL);
+    avr_irq_register_notify(model_pin(uno,  'D', 4), on_uno_profile, NULL);
+
+    if (script) load_script(script);
+    else        gen_trips(trips, emg_pct);
+    if (!n_ev) { fprintf(stderr, "cosim: no events\n"); return 2; }
+
+    /* Input changes as (cycle, action) pairs, applied on the MEGA */
+    const uint64_t end = ev[n_ev - 1].at + MS(10000);
+    int      next = 0;
+    uint64_t key_up = 0, emg_up = 0;
+
+    while (mega->cycle < end) {
+        const uint64_t now = mega->cycle;
+        while (next < n_ev && ev[next].at <= now) {
+            if (ev[next].kind == 'k') {
+                model_keypad_hold(mega, model_keypad_code(ev[next].key));
+                key_up    = now + MS(KEY_HOLD_MS);
+                t_key     = now;               /* the last key counts  */
+                t_led_cmd = 0;
+            } else {
+                avr_raise_irq(model_pin(mega, 'E', 4), 0);
+                emg_up    = now + MS(EMG_HOLD_MS);
+                t_emg     = now;
+                t_emg_cmd = 0;
+            }
+            next++;
+        }
+        if (key_up && now >= key_up) { model_keypad_hold(mega, KEY_NONE); key_up = 0; }
+        if (emg_up && now >= emg_up) { avr_raise_irq(model_pin(mega, 'E', 4), 1); emg_up = 0; }
+
+        avr_t *const avr = (mega->cycle <= uno->cycle) ? mega : uno;
+        const int st = avr_run(avr);
+        if (st == cpu_Done || st == cpu_Crashed) {
+            fprintf(stderr, "cosim: %s stopped at cycle %llu\n",
+                    avr == mega ? "MEGA" : "UNO", (unsigned long long)avr->cycle);
+            return 2;
+        }
+    }
+
+    if (json)
+        printf("{\"metric\":\"boot\",\"prompt_us\":%.1f,\"uno_ready_us\":%.1f}\n",
+               (double)t_prompt / CYC_PER_US, (double)t_uno_ready / CYC_PER_US);
+    else
+        printf("boot: \"%s\" after %.2f ms, UNO ready after %.2f ms (0 = never)\n\n"
+               "%-18s %5s %10s %10s %10s %10s %10s   (us)\n",
+               PROMPT, (double)t_prompt / (CYC_PER_US * 1000), (double)t_uno_ready / (CYC_PER_US * 1000),
+               "metric", "n", "min", "p50", "p90", "p99", "max");
+    report(&key_to_led, json);
+    report(&emg_to_sound, json);
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-s script | -r trips] [-e emergency%%] [-S seed] [-j] [-v] mega.elf uno.elf\n",
+            argv[0]);
+    return 2;
+}
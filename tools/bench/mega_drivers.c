@@ -0,0 +1,89 @@
+/*************************************************************
+ * mega_drivers.c  — bench image: LCD, keypad and SPI master
+ *                   drivers (ATmega2560)
+ *
+ * keypad.c and telemetry.c are included rather than linked, so
+ * that static helpers such as keypad_ScanKey() can be timed.
+ * simbench holds the LCD data lines low (display never busy,
+ * address counter 0), so the LCD figures are MCU cycles only,
+ * and models the 4x4 keypad from the GPIOR2 stimulus.  Both keypad figures include the
+ * 1 ms DELAY_ms() per scanned row.
+ *************************************************************/
+#include "bench.h"
+#include "hal.h"
+#include "lcd.h"
+#include "keypad.c"
+#include "telemetry.c"
+
+#define KEY(row, col)   (0x80 | (row) << 2 | (col))
+
+int main(void)
+{
+    bench_begin();
+
+    lcd_init(LCD_DISP_ON);
+    KEYPAD_Init();
+
+    bench_case("lcd_putc");
+    for (char c = 'A'; c < 'A' + 16; c++) BENCH(lcd_putc(c));
+
+    bench_case("lcd_putc_newline");
+    for (uint8_t i = 0; i < 4; i++) BENCH(lcd_putc('\n'));
+
+    bench_case("lcd_gotoxy");
+    for (uint8_t y = 0; y < 2; y++)
+        for (uint8_t x = 0; x < 16; x += 5) BENCH(lcd_gotoxy(x, y));
+
+    bench_case("lcd_clrscr");
+    BENCH(lcd_clrscr());
+
+    /* Rows are scanned top to bottom, so row 3 is the longest path */
+    for (uint8_t row = 0; row < 4; row++) {
+        static const char *const names[4] = {
+            "keypad_scan_row0", "keypad_scan_row1",
+            "keypad_scan_row2", "keypad_scan_row3" };
+        bench_case(names[row]);
+        for (uint8_t col = 0; col < 4; col++) {
+            BENCH_STIM(KEY(row, col));
+            BENCH(keypad_ScanKey());
+        }
+    }
+    bench_case("keypad_scan_none");
+    BENCH_STIM(0);
+    BENCH(keypad_ScanKey());
+
+    DDRB |= _BV(PB0) | _BV(PB1) | _BV(PB2);
+    PORTB |= _BV(PB0);
+    SPCR  =  _BV(SPE) | _BV(MSTR) | _BV(SPR0);
+
+    bench_case("spi_cmd");                   /* hal_spi_frame(&op, 1) */
+    for (uint8_t i = 0; i < 8; i++) {
+        const uint8_t op = 0x25;
+        BENCH(hal_spi_frame(&op, 1));
+    }
+
+    bench_case("spi_frame4");                /* led_fade()/led_blink() */
+    for (uint8_t i = 0; i < 4; i++) {
+        const uint8_t f[4] = { 0x15, 0x02, 0xFF, 40 };
+        BENCH(hal_spi_frame(f, 4));
+    }
+
+    bench_case("tlm_emit");
+    for (uint8_t i = 0; i < 8; i++) {
+        tx_head = tx_tail = 0;                /* ring empty each time  */
+        BENCH(tlm_emit2(TLM_STATE, 1, 2));
+    }
+
+    /* What a save costs the FSM: the enqueue only.  The image runs
+       with interrupts off, so let EE_READY drain between saves.   */
+    bench_case("nv_update5");                /* one snapshot record   */
+    for (uint8_t i = 0; i < 4; i++) {
+        const uint8_t rec[5] = { i, 0, 3, 7, 0x5A };
+        BENCH(hal_nv_update(0x100 + 5 * i, rec, sizeof rec));
+        sei();
+        hal_nv_flush();
+        cli();
+    }
+
+    bench_end();
+}
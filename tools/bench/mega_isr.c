@@ -0,0 +1,40 @@
+/*************************************************************
+ * mega_isr.c  — bench image: MEGA interrupt handlers
+ *************************************************************/
+#include "bench.h"
+#include "hal.h"
+#include "telemetry.c"           /* static ring, for a full drain */
+
+int main(void)
+{
+    bench_begin();
+
+    TCCR1B = _BV(WGM12) | _BV(CS12) | _BV(CS10);
+    OCR1A  = (F_CPU/1024/100) - 1;
+
+    bench_case("TIMER1_COMPA_vect");         /* 10 ms tick            */
+    for (uint8_t i = 0; i < 8; i++) BENCH_ISR(TIMER1_COMPA_vect);
+
+    bench_case("INT4_vect");                 /* emergency edge + stamp */
+    for (uint8_t i = 0; i < 8; i++) BENCH_ISR(INT4_vect);
+
+    UCSR0B = _BV(TXEN0);
+    bench_case("USART0_UDRE_vect");          /* telemetry drain       */
+    tlm_emit2(TLM_STATE, 1, 2);
+    for (uint8_t i = 0; i < 8; i++) BENCH_ISR(USART0_UDRE_vect);
+
+    /* One queued byte each; the write itself is the EEPROM's 3.4 ms */
+    bench_case("EE_READY_vect");             /* byte differs: write   */
+    for (uint8_t i = 0; i < 8; i++) {
+        hal_nv_update(0x100 + i, &i, 1);
+        BENCH_ISR(EE_READY_vect);
+        while (EECR & _BV(EEPE)) ;
+    }
+    bench_case("EE_READY_vect_same");        /* already there: skip   */
+    for (uint8_t i = 0; i < 8; i++) {
+        hal_nv_update(0x100 + i, &i, 1);
+        BENCH_ISR(EE_READY_vect);
+    }
+
+    bench_end();
+}
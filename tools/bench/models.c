@@ -0,0 +1,67 @@
+/*************************************************************
+ * models.c  — simavr pin models (see models.h)
+ *************************************************************/
+#include <string.h>
+
+#include <sim_io.h>
+#include <avr_ioport.h>
+#include "models.h"
+
+/* Layout from the decode table in keypad.c: row r, column c */
+static const char layout[4][5] = { "147*", "2580", "369#", "ABCD" };
+
+static uint8_t held;                   /* KEY_CODE() or KEY_NONE    */
+static uint8_t rows = 0xFF;            /* last PORTK output         */
+
+avr_irq_t *model_pin(avr_t *avr, char port, int bit)
+{
+    return avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), bit);
+}
+
+void model_lcd_ready(avr_t *mega)
+{
+    avr_raise_irq(model_pin(mega, 'E', 5), 0);    /* D4..D7 */
+    avr_raise_irq(model_pin(mega, 'G', 5), 0);
+    avr_raise_irq(model_pin(mega, 'E', 3), 0);
+    avr_raise_irq(model_pin(mega, 'H', 3), 0);
+}
+
+static void keypad_update(avr_t *mega)
+{
+    for (int col = 0; col < 4; col++) {
+        int level = 1;
+        if (held & 0x80) {
+            const int r = (held >> 2) & 3, c = held & 3;
+            if (c == col && !(rows & (0x10 << r))) level = 0;
+        }
+        avr_raise_irq(model_pin(mega, 'K', col), level);
+    }
+}
+
+static void on_portk(avr_irq_t *irq, uint32_t value, void *param)
+{
+    (void)irq;
+    rows = (uint8_t)value;
+    keypad_update(param);
+}
+
+void model_keypad_init(avr_t *mega)
+{
+    avr_irq_register_notify(model_pin(mega, 'K', IOPORT_IRQ_PIN_ALL), on_portk, mega);
+    keypad_update(mega);
+}
+
+void model_keypad_hold(avr_t *mega, uint8_t code)
+{
+    held = code;
+    keypad_update(mega);
+}
+
+uint8_t model_keypad_code(char key)
+{
+    for (int r = 0; r < 4; r++) {
+        const char *p = strchr(layout[r], key);
+        if (key && p) return KEY_CODE(r, (int)(p - layout[r]));
+    }
+    return KEY_NONE;
+}
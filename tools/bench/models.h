@@ -0,0 +1,26 @@
+/*************************************************************
+ * models.h  — simavr pin models shared by simbench and cosim
+ *
+ *   LCD      the four data lines are held low, so the HD44780
+ *            never reports busy and the address counter reads 0
+ *   keypad   4x4 matrix on PORTK: rows PK4..7 are driven by the
+ *            MEGA, columns PK0..3 read low where the held key's
+ *            row is low, high (pull-up) otherwise
+ *************************************************************/
+#ifndef MODELS_H
+#define MODELS_H
+
+#include <stdint.h>
+#include <sim_avr.h>
+#include <sim_irq.h>
+
+#define KEY_NONE        0
+#define KEY_CODE(r, c)  (0x80 | (r) << 2 | (c))   /* GPIOR2 stimulus */
+
+avr_irq_t *model_pin(avr_t *avr, char port, int bit);
+void       model_lcd_ready(avr_t *mega);
+void       model_keypad_init(avr_t *mega);
+void       model_keypad_hold(avr_t *mega, uint8_t code);
+uint8_t    model_keypad_code(char key);   /* KEY_NONE if not on the pad */
+
+#endif /* MODELS_H */
@@ -0,0 +1,292 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : simbench.c   — cycle benchmarks of AVR bench images
+ * Purpose  : Run an image built with bench.h under simavr, count the
+ *            cycles between its markers and print one JSON object per
+ *            case; or compare two such files against each other.
+ * Licence  : MIT
+ *
+ *   simbench -m mcu [-f hz] [-n name] image.elf    > results.jsonl
+ *   simbench -c baseline.jsonl results.jsonl [-t pct]
+ *
+ *   -m   simavr core: atmega2560 or atmega328p; also selects the pin
+ *        models below
+ *   -n   bench name in the output (default: file name without .elf)
+ *   -c   compare: exit 1 if any case's avg or max cycles grew by
+ *        more than -t percent (default 0: simavr is deterministic)
+ *
+ * Output, one line per case:
+ *
+ *   {"bench":"uno_isr","case":"spi_ding","mcu":"atmega328p","n":4,
+ *    "min":142,"avg":142.0,"max":142,"max_at":0}
+ *
+ * max_at is the 0-based call that took longest, i.e. which input or
+ * which note of a melody hit the worst-case path.
+ *
+ * Pin models
+ *   atmega2560   LCD data lines held low (never busy); a 4x4 keypad on
+ *                PORTK whose held key is the image's GPIOR2 stimulus
+ *                (0x80 | row << 2 | col, 0 = none)
+ *   atmega328p   SS (PB2) held low, as inside a frame; a GPIOR2 write
+ *                is a byte from the master (SPI_IRQ_INPUT), which the
+ *                image's next SPDR read returns
+ ***********************************************************************/
+#define _DEFAULT_SOURCE
+#include <libgen.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sim_avr.h>
+#include <sim_elf.h>
+#include <sim_io.h>
+#include <avr_ioport.h>
+#include <avr_spi.h>
+#include "models.h"
+
+#define IO_GPIOR0      0x3E            /* data-space addresses, the */
+#define IO_GPIOR1      0x4A            /* same on both parts        */
+#define IO_GPIOR2      0x4B
+
+#define MARK_START     1
+#define MARK_STOP      2
+#define MARK_DONE      0xFF
+
+#define MAX_CASES      64
+#define NAME_LEN       32
+#define CYCLE_LIMIT    2000000000ULL   /* a hung image */
+
+typedef struct {
+    char     name[NAME_LEN];
+    uint64_t n, min, max, sum, max_at;
+} bcase_t;
+
+static bcase_t  cases[MAX_CASES];
+static int      n_cases;
+static char     name_buf[NAME_LEN];
+static int      name_len;
+static uint64_t t_start;
+static int      running, done;
+
+/* --- markers -------------------------------------------------------- */
+static void on_gpior0(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+    (void)addr; (void)param;
+    if (v == MARK_START) {
+        t_start = avr->cycle;
+        running = 1;
+    } else if (v == MARK_STOP && running && n_cases) {
+        bcase_t *c = &cases[n_cases - 1];
+        const uint64_t dt = avr->cycle - t_start;
+        if (!c->n || dt < c->min) c->min = dt;
+        if (!c->n || dt > c->max) { c->max = dt; c->max_at = c->n; }
+        c->sum += dt;
+        c->n++;
+        running = 0;
+    } else if (v == MARK_DONE) {
+        done = 1;
+    }
+}
+
+static void on_gpior1(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+    (void)avr; (void)addr; (void)param;
+    if (v && name_len < NAME_LEN - 1) {
+        name_buf[name_len++] = (char)v;
+        return;
+    }
+    if (v) return;
+    name_buf[name_len] = '\0';
+    name_len = 0;
+    if (n_cases == MAX_CASES) {
+        fprintf(stderr, "simbench: more than %d cases\n", MAX_CASES);
+        exit(2);
+    }
+    memset(&cases[n_cases], 0, sizeof cases[0]);
+    strcpy(cases[n_cases++].name, name_buf);
+}
+
+/* --- pin models (models.h) ------------------------------------------ */
+static void on_gpior2(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+    (void)addr; (void)param;
+    model_keypad_hold(avr, v);
+}
+
+static void models_mega(avr_t *avr)
+{
+    model_lcd_ready(avr);
+    model_keypad_init(avr);
+    avr_register_io_write(avr, IO_GPIOR2, on_gpior2, NULL);
+}
+
+/* Writing SPDR on a slave only loads the transmit side; a received
+   byte has to come in through the SPI input, as in cosim          */
+static void on_gpior2_uno(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+    (void)addr; (void)param;
+    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_INPUT), v);
+}
+
+static void models_uno(avr_t *avr)
+{
+    avr_raise_irq(model_pin(avr, 'B', 2), 0); /* SS active           */
+    avr_register_io_write(avr, IO_GPIOR2, on_gpior2_uno, NULL);
+}
+
+/* --- run ------------------------------------------------------------ */
+static int run(const char *elf, const char *mcu, uint32_t hz, const char *bench)
+{
+    elf_firmware_t fw;
+    memset(&fw, 0, sizeof fw);
+    if (elf_read_firmware(elf, &fw)) {
+        fprintf(stderr, "simbench: cannot read %s\n", elf);
+        return 2;
+    }
+    avr_t *avr = avr_make_mcu_by_name(mcu);
+    if (!avr) {
+        fprintf(stderr, "simbench: unknown mcu %s\n", mcu);
+        return 2;
+    }
+    avr_init(avr);
+    avr->frequency = hz;
+    avr_load_firmware(avr, &fw);
+
+    avr_register_io_write(avr, IO_GPIOR0, on_gpior0, NULL);
+    avr_register_io_write(avr, IO_GPIOR1, on_gpior1, NULL);
+    if (!strcmp(mcu, "atmega2560")) models_mega(avr);
+    else                            models_uno(avr);
+
+    while (!done) {
+        const int st = avr_run(avr);
+        if (st == cpu_Done || st == cpu_Crashed) break;
+        if (avr->cycle > CYCLE_LIMIT) {
+            fprintf(stderr, "simbench: %s: no end marker after %llu cycles\n",
+                    bench, (unsigned long long)avr->cycle);
+            return 2;
+        }
+    }
+    if (!done) {
+        fprintf(stderr, "simbench: %s: image stopped before bench_end()\n", bench);
+        return 2;
+    }
+
+    /* case 0 is the empty START/STOP pair */
+    const uint64_t ovh = (n_cases && !strcmp(cases[0].name, "overhead")) ? cases[0].min : 0;
+    for (int i = 1; i < n_cases; i++) {
+        const bcase_t *c = &cases[i];
+        if (!c->n) continue;
+        printf("{\"bench\":\"%s\",\"case\":\"%s\",\"mcu\":\"%s\",\"n\":%llu,"
+               "\"min\":%llu,\"avg\":%.1f,\"max\":%llu,\"max_at\":%llu}\n",
+               bench, c->name, mcu, (unsigned long long)c->n,
+               (unsigned long long)(c->min - ovh),
+               (double)c->sum / c->n - ovh,
+               (unsigned long long)(c->max - ovh),
+               (unsigned long long)c->max_at);
+    }
+    return 0;
+}
+
+/* --- compare -------------------------------------------------------- */
+typedef struct {
+    char   bench[NAME_LEN], name[NAME_LEN];
+    double avg;
+    unsigned long long max;
+} rec_t;
+
+static int load(const char *path, rec_t *r, int cap)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); exit(2); }
+    char line[512];
+    int  n = 0;
+    while (n < cap && fgets(line, sizeof line, f)) {
+        char mcu[NAME_LEN];
+        unsigned long long cnt, min;
+        if (sscanf(line, "{\"bench\":\"%31[^\"]\",\"case\":\"%31[^\"]\",\"mcu\":\"%31[^\"]\","
+                         "\"n\":%llu,\"min\":%llu,\"avg\":%lf,\"max\":%llu",
+                   r[n].bench, r[n].name, mcu, &cnt, &min, &r[n].avg, &r[n].max) == 7)
+            n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static int compare(const char *base_path, const char *cur_path, double tol)
+{
+    static rec_t base[1024], cur[1024];
+    const int nb = load(base_path, base, 1024);
+    const int nc = load(cur_path, cur, 1024);
+    const double k = 1.0 + tol / 100.0;
+    int bad = 0;
+
+    printf("%-14s %-22s %10s %10s %10s %10s\n",
+           "bench", "case", "avg base", "avg now", "max base", "max now");
+    for (int i = 0; i < nc; i++) {
+        const rec_t *b = 0;
+        for (int j = 0; j < nb && !b; j++)
+            if (!strcmp(base[j].bench, cur[i].bench) && !strcmp(base[j].name, cur[i].name))
+                b = &base[j];
+        if (!b) {
+            printf("%-14s %-22s %10s %10.1f %10s %10llu  new\n",
+                   cur[i].bench, cur[i].name, "-", cur[i].avg, "-", cur[i].max);
+            continue;
+        }
+        const int worse = cur[i].avg > b->avg * k + 0.05 || cur[i].max > b->max * k + 0.5;
+        bad |= worse;
+        printf("%-14s %-22s %10.1f %10.1f %10llu %10llu%s\n",
+               cur[i].bench, cur[i].name, b->avg, cur[i].avg, b->max, cur[i].max,
+               worse ? "  REGRESSION" : "");
+    }
+    for (int j = 0; j < nb; j++) {               /* dropped from the image */
+        int found = 0;
+        for (int i = 0; i < nc && !found; i++)
+            found = !strcmp(base[j].bench, cur[i].bench) && !strcmp(base[j].name, cur[i].name);
+        if (!found)
+            printf("%-14s %-22s %10.1f %10s %10llu %10s  missing\n",
+                   base[j].bench, base[j].name, base[j].avg, "-", base[j].max, "-");
+    }
+    return bad;
+}
+
+int main(int argc, char **argv)
+{
+    const char *mcu = 0, *name = 0, *base = 0;
+    uint32_t    hz  = 16000000;
+    double      tol = 0;
+    int         opt;
+
+    while ((opt = getopt(argc, argv, "m:f:n:c:t:")) != -1) {
+        switch (opt) {
+        case 'm': mcu  = optarg;                       break;
+        case 'f': hz   = (uint32_t)strtoul(optarg, 0, 0); break;
+        case 'n': name = optarg;                       break;
+        case 'c': base = optarg;                       break;
+        case 't': tol  = atof(optarg);                 break;
+        default:  goto usage;
+        }
+    }
+    if (optind != argc - 1) goto usage;
+
+    if (base) return compare(base, argv[optind], tol);
+    if (!mcu) goto usage;
+
+    char bench[NAME_LEN];
+    if (name) {
+        snprintf(bench, sizeof bench, "%s", name);
+    } else {
+        char tmp[256];
+        snprintf(tmp, sizeof tmp, "%s", argv[optind]);
+        snprintf(bench, sizeof bench, "%s", basename(tmp));
+        char *dot = strrchr(bench, '.');
+        if (dot) *dot = '\0';
+    }
+    return run(argv[optind], mcu, hz, bench);
+
+usage:
+    fprintf(stderr, "usage: %s -m mcu [-f hz] [-n name] image.elf\n"
+                    "       %s -c baseline.jsonl [-t pct] results.jsonl\n", argv[0], argv[0]);
+    return 2;
+}
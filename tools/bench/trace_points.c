@@ -0,0 +1,29 @@
+/*************************************************************
+ * trace_points.c  — bench image: one trace point (trace.h)
+ *                   with TRACE_ENABLE=1 (ATmega2560)
+ *
+ * The ring is defined here rather than linked from trace.c,
+ * whose dump needs the HAL and telemetry.  trace_isr is the
+ * form used in ISRs; trace_main adds the SREG save and CLI of
+ * main-loop code.  Both store a variable v, as most points do.
+ *************************************************************/
+#include "bench.h"
+#include "trace.h"
+
+trace_ev_t trace_buf[TRACE_DEPTH];
+uint8_t    trace_head;
+
+int main(void)
+{
+    bench_begin();
+
+    TCCR1B = _BV(CS12) | _BV(CS10);          /* 64 us, as the firmware */
+
+    bench_case("trace_isr");
+    for (uint8_t i = 0; i < 8; i++) BENCH(TRACE_ISR(TR_ISR_TICK, i));
+
+    bench_case("trace_main");
+    for (uint8_t i = 0; i < 8; i++) BENCH(TRACE(TR_FSM_STATE, i));
+
+    bench_end();
+}
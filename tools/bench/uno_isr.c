@@ -0,0 +1,131 @@
+/*************************************************************
+ * uno_isr.c  — bench image: UNO interrupt handlers (ATmega328P)
+ *
+ * main.c is included with its main() renamed, so the SPI ISR
+ * runs with the real decoder; the other modules are linked as
+ * in the firmware.  simbench holds SS (PB2) low, as during a
+ * frame.  A received byte is the GPIOR2 stimulus: simbench
+ * feeds it to the SPI input, so the ISR's SPDR read returns it
+ * as on silicon.  SPIF stays pending; the image runs with
+ * interrupts off, so only the timed CALL enters the ISR.
+ *
+ * "spi_emergency" is the emergency latency on the UNO: from the
+ * opcode arriving to the arbiter having started the melody
+ * (plus the hardware entry, see bench.h).
+ *************************************************************/
+#include "bench.h"
+#define main uno_main
+#include "main.c"
+#undef main
+#include "sequencer.h"
+#include "synth.h"
+
+/* One SPI byte through the real ISR */
+#define SPI_RX(b)        do { BENCH_STIM(b); BENCH_ISR(SPI_STC_vect); } while (0)
+#define SPI_RX_QUIET(b)  do { BENCH_STIM(b); BENCH_CALL(SPI_STC_vect); } while (0)
+
+static void idle(void)
+{
+    audio_stop();
+    led_set(LED_MASK_MOVEMENT | LED_MASK_DOOR, 0);
+    audio_poll();
+    led_poll();
+}
+
+int main(void)
+{
+    bench_begin();
+
+    led_init();
+    audio_init();
+    power_init();
+    spi_slave_init();
+    cli();
+
+    /* --- SPI_STC_vect, one case per decoder path ------------------ */
+    bench_case("spi_status");
+    for (uint8_t i = 0; i < 4; i++) SPI_RX(CMD_STATUS);
+
+    bench_case("spi_led_on");
+    for (uint8_t i = 0; i < 4; i++) { idle(); SPI_RX(CMD_MOVEMENT_LED_ON); }
+
+    bench_case("spi_ding");                  /* idle → chime starts   */
+    for (uint8_t i = 0; i < 4; i++) { idle(); SPI_RX(CMD_DING); }
+
+    bench_case("spi_emergency");             /* pre-empts the chime   */
+    for (uint8_t i = 0; i < 4; i++) {
+        idle(); SPI_RX_QUIET(CMD_DING); SPI_RX(CMD_BUZZER_PLAY_ONESHOT);
+    }
+
+    bench_case("spi_ding_dropped");          /* below the melody      */
+    for (uint8_t i = 0; i < 4; i++) {
+        idle(); SPI_RX_QUIET(CMD_BUZZER_PLAY_ONESHOT); SPI_RX(CMD_DING);
+    }
+
+    bench_case("spi_fade_last_arg");         /* led_fade() stored     */
+    for (uint8_t i = 0; i < 4; i++) {
+        idle();
+        SPI_RX_QUIET(CMD_LED_FADE); SPI_RX_QUIET(LED_MASK_DOOR); SPI_RX_QUIET(255);
+        SPI_RX(40);
+    }
+
+    bench_case("spi_blink_last_arg");        /* led_blink() armed     */
+    for (uint8_t i = 0; i < 4; i++) {
+        idle();
+        SPI_RX_QUIET(CMD_LED_BLINK); SPI_RX_QUIET(LED_MASK_MOVEMENT); SPI_RX_QUIET(3);
+        SPI_RX(100);
+    }
+
+    bench_case("spi_power_stats");
+    for (uint8_t i = 0; i < 4; i++) SPI_RX(CMD_POWER_STATS);
+
+    bench_case("spi_read");
+    for (uint8_t i = 0; i < POWER_STATS_LEN; i++) SPI_RX(CMD_READ);
+
+    /* --- TIMER1_COMPA_vect: every edge of the emergency melody ---- */
+    idle();
+    audio_request(SND_EMERGENCY);
+    bench_case("seq_edge");
+    while (seq_busy(SEQ_CH_MELODY)) BENCH_ISR(TIMER1_COMPA_vect);
+
+#if AUDIO_SYNTH
+    /* --- TIMER2_OVF_vect: sample ISR, 1 voice then all voices ----- */
+    idle();
+    synth_note_on(0, SYNTH_INC(440), &instr_reed);
+    bench_case("synth_1_voice");
+    for (uint16_t i = 0; i < 2 * SYNTH_ENV_DIV; i++) BENCH_ISR(TIMER2_OVF_vect);
+
+    for (uint8_t v = 1; v < SYNTH_VOICES; v++)
+        synth_note_on(v, SYNTH_INC(440 + 110 * v), &instr_bell);
+    bench_case("synth_all_voices");
+    for (uint16_t i = 0; i < 2 * SYNTH_ENV_DIV; i++) BENCH_ISR(TIMER2_OVF_vect);
+    synth_stop();
+#endif
+
+    /* --- Timer-0 LED engine --------------------------------------- */
+    idle();
+    led_set(LED_MASK_MOVEMENT | LED_MASK_DOOR, 128);
+    bench_case("led_ovf_dimmed");
+    for (uint8_t i = 0; i < 8; i++) BENCH_ISR(TIMER0_OVF_vect);
+
+    led_fade(LED_MASK_MOVEMENT | LED_MASK_DOOR, 255, 100);
+    led_poll();
+    bench_case("led_ovf_fading");            /* every 2nd: fade step  */
+    for (uint8_t i = 0; i < 16; i++) BENCH_ISR(TIMER0_OVF_vect);
+
+    led_blink(LED_MASK_MOVEMENT | LED_MASK_DOOR, 3, 100);
+    bench_case("led_ovf_blinking");
+    for (uint8_t i = 0; i < 16; i++) BENCH_ISR(TIMER0_OVF_vect);
+
+    bench_case("led_compa");
+    for (uint8_t i = 0; i < 8; i++) BENCH_ISR(TIMER0_COMPA_vect);
+
+    /* --- arbiter from the main loop ------------------------------- */
+    bench_case("audio_request_ding");
+    for (uint8_t i = 0; i < 4; i++) { idle(); BENCH(audio_request(SND_DING)); }
+
+    bench_case("TIMER1_OVF_vect");           /* power time base       */
+    for (uint8_t i = 0; i < 4; i++) BENCH_ISR(TIMER1_OVF_vect);
+
+    bench_end();
+}
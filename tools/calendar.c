@@ -0,0 +1,70 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : calendar.c   — binary-heap event calendar (see calendar.h)
+ * Licence  : MIT
+ ***********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "calendar.h"
+
+static int earlier(const cal_event_t *a, const cal_event_t *b)
+{
+    return a->at_us < b->at_us || (a->at_us == b->at_us && a->seq < b->seq);
+}
+
+void cal_init(calendar_t *c)
+{
+    memset(c, 0, sizeof *c);
+}
+
+void cal_free(calendar_t *c)
+{
+    free(c->ev);
+    cal_init(c);
+}
+
+void cal_push(calendar_t *c, uint64_t at_us, cal_fn fn, void *ctx, uint64_t arg)
+{
+    if (c->n == c->cap) {
+        c->cap = c->cap ? c->cap * 2 : 64;
+        c->ev  = realloc(c->ev, c->cap * sizeof *c->ev);
+        if (!c->ev) { fprintf(stderr, "calendar: out of memory\n"); exit(2); }
+    }
+
+    /* Sift up from the new leaf */
+    const cal_event_t e = { at_us, c->next_seq++, fn, ctx, arg };
+    size_t i = c->n++;
+    while (i && earlier(&e, &c->ev[(i - 1) / 2])) {
+        c->ev[i] = c->ev[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    c->ev[i] = e;
+}
+
+const cal_event_t *cal_peek(const calendar_t *c)
+{
+    return c->n ? &c->ev[0] : NULL;
+}
+
+int cal_pop(calendar_t *c, cal_event_t *out)
+{
+    if (!c->n) return 0;
+    *out = c->ev[0];
+    c->fired++;
+
+    /* Sift the last leaf down from the root */
+    const cal_event_t last = c->ev[--c->n];
+    size_t i = 0;
+    for (;;) {
+        size_t k = 2 * i + 1;
+        if (k >= c->n) break;
+        if (k + 1 < c->n && earlier(&c->ev[k + 1], &c->ev[k])) k++;
+        if (!earlier(&c->ev[k], &last)) break;
+        c->ev[i] = c->ev[k];
+        i = k;
+    }
+    if (c->n) c->ev[i] = last;
+    return 1;
+}
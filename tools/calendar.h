@@ -0,0 +1,41 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : calendar.h   — event calendar for the discrete-event simulator
+ * Licence  : MIT
+ *
+ * A binary min-heap of timed events.  Events due at the same time come
+ * out in the order they were scheduled (a sequence number breaks the
+ * tie), so a run never depends on the heap's internal order.
+ *
+ * push and pop are O(log n); the heap grows as needed.
+ ***********************************************************************/
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void (*cal_fn)(void *ctx, uint64_t arg);
+
+typedef struct {
+    uint64_t at_us;                    /* due time                  */
+    uint64_t seq;                      /* scheduling order          */
+    cal_fn   fn;
+    void    *ctx;
+    uint64_t arg;
+} cal_event_t;
+
+typedef struct {
+    cal_event_t *ev;
+    size_t       n, cap;
+    uint64_t     next_seq;
+    uint64_t     fired;                /* popped so far             */
+} calendar_t;
+
+void               cal_init(calendar_t *c);
+void               cal_free(calendar_t *c);
+void               cal_push(calendar_t *c, uint64_t at_us, cal_fn fn, void *ctx, uint64_t arg);
+const cal_event_t *cal_peek(const calendar_t *c);    /* NULL if empty */
+int                cal_pop(calendar_t *c, cal_event_t *out);  /* 0 if empty */
+
+#endif /* CALENDAR_H */
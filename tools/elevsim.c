@@ -0,0 +1,604 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : elevsim.c   — run the MEGA controller FSM on Linux
+ * Purpose  : Drive Project_MEGA/elevator.c through the fake HAL with
+ *            a random passenger and report trips per wall-clock second;
+ *            or replay the inputs of a recorded run and check that the
+ *            FSM does exactly the same again.
+ * Licence  : MIT
+ *
+ *   elevsim [-n trips] [-e emergency%] [-t think_ms] [-x resets] [-S seed] [-L [-C]] [-v] [-w out]
+ *   elevsim -D hours [-a per_hour] [-k] [-e ...] [-t ...] [-x ...] [-S ...] [-L [-C]] [-v] [-w out]
+ *   elevsim -r capture [-v] [-w out]
+ *
+ *   -n   trips to run (default 10000); a trip ends back in IDLE
+ *   -e   chance that the button is pressed during a trip (default 5)
+ *   -t   passenger think time before each key (default 300 ms)
+ *   -S   random seed (default 1); the same seed gives the same run
+ *   -v   print every state change with its simulated time
+ *   -D   run for *hours* of simulated time instead of -n trips, with
+ *        passengers arriving at random (Poisson, -a per hour, default
+ *        60) and queueing for the lift; idle time is skipped
+ *   -k   step time in 10 ms ticks instead of jumping to the next event
+ *        (hal_sim.h), to compare against
+ *   -x   reset the MEGA this many times, each somewhere in the 20
+ *        simulated minutes after the last boot, and check that it
+ *        resumes from the EEPROM snapshot (persist.h) exactly where
+ *        it was: floor, state and, when moving, the target
+ *   -L   at the end, read the event log back as 'L' does on the board
+ *        (evlog.h), into -w too, and check that its sequence numbers
+ *        run without a gap across the resets
+ *   -C   with -L: first corrupt the middle record of the log, as a
+ *        power cut during its write would, and reopen it as a reset
+ *        does; the read-back must show exactly that one gap and the
+ *        same span, oldest record included
+ *   -w   write the telemetry stream to *out*, framed as the MEGA sends
+ *        it on USART0 (teledec reads it, -r replays it)
+ *   -r   replay: feed the TLM_INPUT records of a capture (a MEGA built
+ *        with RECORD_ENABLE=1, or -w) back into the FSM, at their
+ *        recorded ticks, and compare what it emits with the capture:
+ *        STATE, FLOOR, KEY, SPI and INPUT records, byte for byte and in
+ *        order.  Exit 1 at the first difference.  Replays the first
+ *        boot in the file.
+ *
+ * Every run also checks the longest stretch without a watchdog kick
+ * against HAL_WDT_MS.  Exit 1 if a reset lost the car's position, the
+ * event log has a gap or the watchdog would have fired.
+ ***********************************************************************/
+#define _POSIX_C_SOURCE 199309L
+#include <inttypes.h>
+#include <math.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "elevator.h"
+#include "evlog.h"
+#include "hal.h"
+#include "hal_sim.h"
+#include "nvring.h"
+#include "persist.h"
+#include "record.h"
+#include "telemetry.h"
+
+#define QUEUE_LEN   256                /* waiting passengers, -D    */
+
+/* Mirrors state_t in Project_MEGA/elevator.h */
+static const char *const state_names[] = { "IDLE", "MOVING", "DOOR", "EMERGENCY" };
+
+typedef struct {
+    elevator_t lift;
+    uint64_t   rng;
+    uint32_t   think_ms;
+    unsigned   emg_pct;
+    int        verbose;
+
+    char       pending[2];             /* digits still to type      */
+    uint8_t    n_pending;
+
+    uint64_t   trips, faults, emergencies, floors;
+
+    /* -D: passengers queue for the lift between arrivals */
+    double     per_hour;
+    uint64_t   end_us;
+    uint8_t    queue[QUEUE_LEN];       /* requested floors, FIFO    */
+    unsigned   q_head, q_n, q_max;
+    uint64_t   arrivals, balked;
+    jmp_buf    day_over;
+
+    /* -x: MEGA resets */
+    uint64_t   max_resets, resets, resumed, lost;
+    jmp_buf    reset;
+
+    /* -L: the event log as dumped */
+    uint16_t   log_count, log_next;    /* header; seq expected next */
+    uint64_t   log_records, log_gaps;
+} run_t;
+
+/*----------------------------------------------------------------------
+  Captures: COBS frames of [type][tick10ms:4][payload], as telemetry.c
+  --------------------------------------------------------------------*/
+typedef struct {
+    uint8_t  type, len;
+    uint32_t tick;
+    uint8_t  p[TLM_MAX_PAYLOAD];
+} rec_t;
+
+static FILE *cap_out;
+
+static void cap_write(uint8_t type, const uint8_t *p, uint8_t len)
+{
+    const uint32_t t = (uint32_t)(sim.now_us / 10000);
+    uint8_t raw[TLM_HEADER_LEN + TLM_MAX_PAYLOAD] = {
+        type, (uint8_t)t, (uint8_t)(t >> 8), (uint8_t)(t >> 16), (uint8_t)(t >> 24) };
+    uint8_t enc[sizeof raw + 2];
+    const int n = TLM_HEADER_LEN + len;
+    int at = 0, o = 1;
+    uint8_t code = 1;
+
+    memcpy(raw + TLM_HEADER_LEN, p, len);
+    for (int i = 0; i < n; i++) {
+        if (raw[i]) { enc[o++] = raw[i]; code++; }
+        else        { enc[at] = code; at = o++; code = 1; }
+    }
+    enc[at]  = code;
+    enc[o++] = 0x00;
+    fwrite(enc, 1, (size_t)o, cap_out);
+}
+
+/** Decode *n* bytes in place; returns decoded length or -1 if malformed. */
+static int cobs_decode(uint8_t *buf, int n)
+{
+    int in = 0, out = 0;
+    while (in < n) {
+        const uint8_t code = buf[in++];
+        if (code == 0 || in + code - 1 > n) return -1;
+        for (uint8_t i = 1; i < code; i++) buf[out++] = buf[in++];
+        if (code != 0xFF && in < n) buf[out++] = 0;
+    }
+    return out;
+}
+
+/* The records from the first TLM_BOOT up to the next one */
+static rec_t *cap_load(const char *path, size_t *count)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); exit(2); }
+
+    size_t n = 0, cap = 1024;
+    rec_t *r = malloc(cap * sizeof *r);
+    uint8_t frame[64];
+    int flen = 0, c, booted = 0;
+
+    while (r && (c = fgetc(f)) != EOF) {
+        if (c) {
+            if (flen < (int)sizeof frame) frame[flen] = (uint8_t)c;
+            flen++;
+            continue;
+        }
+        const int len = flen <= (int)sizeof frame ? cobs_decode(frame, flen) : -1;
+        flen = 0;
+        if (len < TLM_HEADER_LEN || len > TLM_HEADER_LEN + TLM_MAX_PAYLOAD) continue;
+        if (frame[0] == TLM_BOOT && booted++) break;
+        if (!booted) continue;
+        if (frame[0] == TLM_DROPPED) {
+            fprintf(stderr, "elevsim: %s lost %u records; cannot replay\n",
+                    path, frame[5] | frame[6] << 8);
+            exit(2);
+        }
+        if (n == cap) r = realloc(r, (cap *= 2) * sizeof *r);
+        if (!r) break;
+        r[n].type = frame[0];
+        r[n].tick = frame[1] | frame[2] << 8 | frame[3] << 16 | (uint32_t)frame[4] << 24;
+        r[n].len  = (uint8_t)(len - TLM_HEADER_LEN);
+        memcpy(r[n].p, frame + TLM_HEADER_LEN, r[n].len);
+        n++;
+    }
+    fclose(f);
+    if (!r) { fprintf(stderr, "elevsim: out of memory\n"); exit(2); }
+    if (!booted) { fprintf(stderr, "elevsim: no TLM_BOOT in %s\n", path); exit(2); }
+    *count = n;
+    return r;
+}
+
+/*----------------------------------------------------------------------
+  Replay
+  --------------------------------------------------------------------*/
+typedef struct {
+    run_t    run;                      /* counters and -v           */
+    rec_t   *rec;
+    size_t   n, in, check;             /* next input, next to compare */
+    uint16_t polls;
+    uint64_t inputs, checked;
+    jmp_buf  done;                     /* 1 = log ended, 2 = differs */
+} replay_t;
+
+/* Compared with the capture; the rest depends on the UNO or on time */
+static int replayed_type(uint8_t type)
+{
+    return type == TLM_STATE || type == TLM_FLOOR || type == TLM_KEY ||
+           type == TLM_SPI   || type == TLM_INPUT;
+}
+
+static const rec_t *next_input(replay_t *rp)
+{
+    while (rp->in < rp->n && rp->rec[rp->in].type != TLM_INPUT) rp->in++;
+    return rp->in < rp->n ? &rp->rec[rp->in] : 0;
+}
+
+/* The key from the log, pressed at its recorded tick */
+static char replay_key(void *ctx, uint32_t *think_ms)
+{
+    replay_t *rp = ctx;
+    const rec_t *r = next_input(rp);
+    if (!r) longjmp(rp->done, 1);
+    if (r->p[0] != REC_KEY) {
+        fprintf(stderr, "elevsim: record %zu: the FSM waits for a key, the log has an emergency\n", rp->in);
+        longjmp(rp->done, 2);
+    }
+    const uint64_t at_ms = (uint64_t)r->tick * 10, now_ms = sim.now_us / 1000;
+    *think_ms = at_ms > now_ms ? (uint32_t)(at_ms - now_ms) : 0;
+    rp->in++;
+    rp->inputs++;
+    rp->polls = 0;
+    return (char)r->p[1];
+}
+
+/* The emergency on the poll the board first saw it on */
+static int replay_emg(void *ctx)
+{
+    replay_t *rp = ctx;
+    const rec_t *r = next_input(rp);
+    rp->polls++;
+    if (!r || r->p[0] != REC_EMG || rp->polls != (uint16_t)(r->p[2] | r->p[3] << 8))
+        return 0;
+    rp->in++;
+    rp->inputs++;
+    rp->polls = 0;
+    return 1;
+}
+
+static void replay_tlm(void *ctx, uint8_t type, const uint8_t *p, uint8_t len)
+{
+    replay_t *rp = ctx;
+
+    if (cap_out) cap_write(type, p, len);
+    if (type == TLM_STATE && rp->run.verbose)
+        printf("%12.3f s  %-9s -> %s\n", sim.now_us / 1e6,
+               state_names[p[0]], state_names[p[1]]);
+    if (type == TLM_STATE && p[1] == ST_IDLE) rp->run.trips++;
+    if (!replayed_type(type)) return;
+
+    while (rp->check < rp->n && !replayed_type(rp->rec[rp->check].type)) rp->check++;
+    if (rp->check == rp->n) longjmp(rp->done, 1);    /* capture ends here */
+    const rec_t *want = &rp->rec[rp->check];
+    if (want->type != type || want->len != len || memcmp(want->p, p, len)) {
+        fprintf(stderr, "elevsim: differs at record %zu (tick %" PRIu32 "): capture has 0x%02X",
+                rp->check, want->tick, want->type);
+        for (uint8_t i = 0; i < want->len; i++) fprintf(stderr, " %02X", want->p[i]);
+        fprintf(stderr, ", replay emitted 0x%02X", type);
+        for (uint8_t i = 0; i < len; i++) fprintf(stderr, " %02X", p[i]);
+        fprintf(stderr, "\n");
+        longjmp(rp->done, 2);
+    }
+    rp->check++;
+    rp->checked++;
+}
+
+/* xorshift64*: fast, and the same on every host */
+static uint32_t rnd(run_t *r)
+{
+    r->rng ^= r->rng >> 12;
+    r->rng ^= r->rng << 25;
+    r->rng ^= r->rng >> 27;
+    return (uint32_t)((r->rng * 2685821657736338717ULL) >> 32);
+}
+
+static void request(run_t *r, unsigned floor)
+{
+    if (floor == r->lift.current_floor) r->faults++;
+    r->pending[1] = (char)('0' + floor / 10);
+    r->pending[0] = (char)('0' + floor % 10);
+    r->n_pending  = 2;
+}
+
+/* The passenger reads the LCD like a person would */
+static char passenger(void *ctx, uint32_t *think_ms)
+{
+    run_t *r = ctx;
+    *think_ms = r->think_ms;
+
+    if (strncmp(sim.lcd[1], "Press #", 7) == 0)
+        return '#';
+
+    if (!r->n_pending) request(r, rnd(r) % 100);
+    return r->pending[--r->n_pending];
+}
+
+/* -D: the first one in the queue; 0 = nobody waiting yet */
+static char commuter(void *ctx, uint32_t *think_ms)
+{
+    run_t *r = ctx;
+    *think_ms = r->think_ms;
+
+    if (strncmp(sim.lcd[1], "Press #", 7) == 0)
+        return '#';
+
+    if (!r->n_pending) {
+        if (!r->q_n) return 0;
+        request(r, r->queue[r->q_head]);
+        r->q_head = (r->q_head + 1) % QUEUE_LEN;
+        r->q_n--;
+    }
+    return r->pending[--r->n_pending];
+}
+
+/* Poisson arrivals: exponential gaps at r->per_hour */
+static uint64_t arrival_gap_us(run_t *r)
+{
+    const double u = (rnd(r) + 1.0) / 4294967296.0;
+    return (uint64_t)(-log(u) * 3600e6 / r->per_hour);
+}
+
+static void arrive(void *ctx, uint64_t arg)
+{
+    run_t *r = ctx;
+    (void)arg;
+
+    r->arrivals++;
+    if (r->q_n == QUEUE_LEN) {
+        r->balked++;
+    } else {
+        r->queue[(r->q_head + r->q_n++) % QUEUE_LEN] = (uint8_t)(rnd(r) % 100);
+        if (r->q_n > r->q_max) r->q_max = r->q_n;
+    }
+    const uint64_t next = sim.now_us + arrival_gap_us(r);
+    if (next < r->end_us) sim_at(next, arrive, 0);
+}
+
+static void day_over(void *ctx, uint64_t arg)
+{
+    run_t *r = ctx;
+    (void)arg;
+    longjmp(r->day_over, 1);
+}
+
+
+static void press_emg(void *ctx, uint64_t arg)
+{
+    (void)ctx; (void)arg;
+    sim_emg_press();
+}
+
+static void on_tlm(void *ctx, uint8_t type, const uint8_t *p, uint8_t len)
+{
+    run_t *r = ctx;
+
+    if (cap_out) cap_write(type, p, len);
+    switch (type) {
+    case TLM_LOG:
+        if (len == 2) {                             /* the count     */
+            r->log_count = p[0] | p[1] << 8;
+            break;
+        }
+        for (uint8_t i = 0; i + 5 <= len; i += 5) {
+            const uint16_t seq = p[i] | p[i + 1] << 8;
+            if (r->log_records++ && seq != r->log_next) r->log_gaps++;
+            r->log_next = seq + 1;
+        }
+        break;
+    case TLM_FLOOR:
+        r->floors++;
+        break;
+    case TLM_STATE:
+        if (r->verbose)
+            printf("%12.3f s  %-9s -> %s\n", sim.now_us / 1e6,
+                   state_names[p[0]], state_names[p[1]]);
+        if (p[1] == ST_IDLE) r->trips++;
+        if (p[1] == ST_EMERGENCY) r->emergencies++;
+        /* Press the button somewhere along this trip */
+        if (p[1] == ST_MOVING && rnd(r) % 100 < r->emg_pct) {
+            const unsigned dist = abs((int)r->lift.target_floor - (int)r->lift.current_floor);
+            sim_at(sim.now_us + (uint64_t)(rnd(r) % (dist * FLOOR_TIME_MS + 1)) * 1000,
+                   press_emg, 0);
+        }
+        break;
+    }
+}
+
+/* Until the day_over event */
+static void run_day(run_t *r)
+{
+    if (!setjmp(r->day_over))
+        for (;;) elevator_step(&r->lift);
+}
+
+/* -x: the MEGA resets somewhere in the next 20 simulated minutes */
+static void reset_mega(void *ctx, uint64_t arg)
+{
+    run_t *r = ctx;
+    (void)arg;
+    longjmp(r->reset, 1);
+}
+
+static void schedule_reset(run_t *r)
+{
+    if (r->resets < r->max_resets)
+        sim_at(sim.now_us + (uint64_t)(rnd(r) % 1200000) * 1000, reset_mega, 0);
+}
+
+/* -C: tear the middle record of the event log and reopen it.  The
+   log's span before the tear, which the read-back must still show;
+   0 if it is too short to have a middle.                          */
+static uint16_t tear_log(void)
+{
+    nvring_t log = NVRING(EVLOG_ADDR, EVLOG_SLOTS, EVLOG_LEN, EVLOG_TAG);
+    nvring_open(&log);
+    if (log.count < 3) return 0;
+
+    const uint16_t back = log.count / 2;
+    const uint16_t slot = (log.head + EVLOG_SLOTS - back) % EVLOG_SLOTS;
+    sim_nv_tear(EVLOG_ADDR + NVRING_BYTES(slot, EVLOG_LEN) + 2);  /* kind */
+    evlog_init();
+    return log.count;
+}
+
+/* As main.c: 1 = resumed from the snapshot */
+static uint8_t boot(run_t *r)
+{
+    hal_init();
+    tlm_init();
+    const uint8_t resumed = persist_restore(&r->lift);
+    if (!resumed) elevator_init(&r->lift);       /* or floor 0    */
+    evlog_init();
+    evlog_add(LOG_BOOT, hal_reset_cause(), resumed);
+    return resumed;
+}
+
+/* The car must be where it was */
+static void reboot(run_t *r)
+{
+    const elevator_t was = r->lift;
+
+    sim_reboot(r->resets & 1 ? HAL_RESET_EXTERNAL : HAL_RESET_WATCHDOG);
+    r->resumed += boot(r);
+    r->resets++;
+
+    const int lost = r->lift.current_floor != was.current_floor || r->lift.state != was.state ||
+                     (was.state == ST_MOVING && r->lift.target_floor != was.target_floor);
+    if (lost) r->lost++;
+    if (r->verbose || lost)
+        printf("%12.3f s  RESET in %s at floor %02u -> %s at floor %02u%s\n", sim.now_us / 1e6,
+               state_names[was.state], was.current_floor, state_names[r->lift.state],
+               r->lift.current_floor, lost ? "  LOST" : "");
+    schedule_reset(r);
+}
+
+/* Until *n* trips, or the day_over event with -D; resets on the way */
+static void run(run_t *r, uint64_t n, int day)
+{
+    while (setjmp(r->reset))
+        reboot(r);
+    if (day) run_day(r);
+    else     while (r->trips < n) elevator_step(&r->lift);
+}
+
+static double wall_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Runs until the log has no more keys; 0 = identical, 1 = differs */
+static int replay(const char *path, int verbose)
+{
+    static replay_t rp;
+
+    rp.rec = cap_load(path, &rp.n);
+    rp.run.verbose = verbose;
+    sim_reset(replay_key, replay_tlm, &rp);
+    sim.emg_poll = replay_emg;
+
+    const double t0  = wall_s();
+    const int    end = setjmp(rp.done);
+    if (!end) {
+        hal_init();
+        tlm_init();
+        elevator_init(&rp.run.lift);
+        for (;;) elevator_step(&rp.run.lift);
+    }
+    const double wall = wall_s() - t0;
+    if (end == 2) return 1;
+
+    /* What the board did after its last input must have come out too */
+    while (rp.check < rp.n && !replayed_type(rp.rec[rp.check].type)) rp.check++;
+    if (rp.check < rp.n) {
+        fprintf(stderr, "elevsim: replay stopped at record %zu of %zu (type 0x%02X)\n",
+                rp.check, rp.n, rp.rec[rp.check].type);
+        return 1;
+    }
+
+    const double simulated = sim.now_us / 1e6;
+    printf("replayed     %" PRIu64 " inputs, %" PRIu64 " trips\n", rp.inputs, rp.run.trips);
+    printf("identical    %" PRIu64 " STATE/FLOOR/KEY/SPI/INPUT records\n", rp.checked);
+    printf("simulated    %.1f s in %.3f s -> %.0fx real time\n",
+           simulated, wall, wall > 0 ? simulated / wall : 0.0);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    run_t       r = { .think_ms = 300, .emg_pct = 5 };
+    uint64_t    n = 10000, seed = 1;
+    double      hours = 0;
+    const char *out = 0, *in = 0;
+    int         ticks = 0, dump_log = 0, tear = 0, opt;
+
+    r.per_hour = 60;
+    while ((opt = getopt(argc, argv, "n:e:t:x:S:vw:r:D:a:kLC")) != -1) {
+        switch (opt) {
+        case 'n': n          = strtoull(optarg, 0, 0); break;
+        case 'e': r.emg_pct  = (unsigned)atoi(optarg); break;
+        case 't': r.think_ms = (uint32_t)atoi(optarg); break;
+        case 'S': seed       = strtoull(optarg, 0, 0); break;
+        case 'v': r.verbose  = 1;                      break;
+        case 'w': out        = optarg;                 break;
+        case 'r': in         = optarg;                 break;
+        case 'D': hours      = atof(optarg);           break;
+        case 'a': r.per_hour = atof(optarg);           break;
+        case 'k': ticks      = 1;                      break;
+        case 'x': r.max_resets = strtoull(optarg, 0, 0); break;
+        case 'L': dump_log   = 1;                      break;
+        case 'C': tear       = 1;                      break;
+        default:
+            fprintf(stderr, "usage: %s [-n trips] [-e emergency%%] [-t think_ms] [-x resets] [-S seed] [-L [-C]] [-v] [-w out]\n"
+                            "       %s -D hours [-a per_hour] [-k] [-e ...] [-t ...] [-x ...] [-S ...] [-L [-C]] [-v] [-w out]\n"
+                            "       %s -r capture [-v] [-w out]\n", argv[0], argv[0], argv[0]);
+            return 2;
+        }
+    }
+    r.rng = seed ? seed : 1;
+
+    if (out && !(cap_out = fopen(out, "wb"))) { perror(out); return 2; }
+    if (in) {
+        const int rc = replay(in, r.verbose);
+        if (cap_out) fclose(cap_out);
+        return rc;
+    }
+
+    sim_reset(hours > 0 ? commuter : passenger, on_tlm, &r);
+    if (ticks) sim.tick_us = 10000;
+    if (hours > 0) {
+        if (r.per_hour <= 0) r.per_hour = 60;
+        r.end_us = (uint64_t)(hours * 3600e6);
+        sim_at(arrival_gap_us(&r), arrive, 0);
+        sim_at(r.end_us, day_over, 0);
+    }
+    boot(&r);
+    schedule_reset(&r);
+
+    const double t0 = wall_s();
+    run(&r, n, hours > 0);
+    const double wall = wall_s() - t0;
+    const uint64_t wdt_gap_us = sim.wdt_gap_us;  /* the run's, not the dump's */
+    const uint16_t torn_span = dump_log && tear ? tear_log() : 0;
+    if (dump_log) evlog_dump();
+    if (cap_out) fclose(cap_out);
+
+    const double simulated = sim.now_us / 1e6;
+    printf("trips        %" PRIu64 "  (%" PRIu64 " emergency, %" PRIu64 " fault requests)\n",
+           r.trips, r.emergencies, r.faults);
+    printf("floors       %" PRIu64 "\n", r.floors);
+    printf("spi frames   %" PRIu64 "  telemetry records %" PRIu64 "\n",
+           sim.spi_frames, sim.tlm_records);
+    if (hours > 0)
+        printf("passengers   %" PRIu64 " arrived, %u still queued (at most %u), %" PRIu64 " turned away\n",
+               r.arrivals, r.q_n, r.q_max, r.balked);
+    printf("simulated    %.1f s  (%.2f s per trip)\n", simulated, r.trips ? simulated / r.trips : 0.0);
+    printf("time steps   %" PRIu64 " (%s), %" PRIu64 " events\n",
+           sim.steps, ticks ? "10 ms ticks" : "jumps", sim.cal.fired);
+    if (r.max_resets)
+        printf("resets       %" PRIu64 "  (%" PRIu64 " resumed from EEPROM, %" PRIu64 " lost the car)\n",
+               r.resets, r.resumed, r.lost);
+    uint16_t hot_addr;
+    const uint32_t hot = sim_nv_hottest(&hot_addr);
+    printf("eeprom       %" PRIu64 " bytes written, at most %u to one cell (0x%03X)\n",
+           sim.nv_writes, hot, hot_addr);
+    const unsigned torn    = torn_span != 0;
+    const int      log_bad = dump_log && (r.log_gaps != torn || r.log_records + torn != r.log_count ||
+                                          (torn && r.log_count != torn_span));
+    if (dump_log)
+        printf("event log    %" PRIu64 " of %u records read back, seq up to %u, %" PRIu64 " gaps%s\n",
+               r.log_records, r.log_count, (uint16_t)(r.log_next - 1), r.log_gaps,
+               torn ? " (1 torn by -C)" : "");
+    printf("watchdog     %.1f ms longest without a kick (fires at %u ms)\n",
+           wdt_gap_us / 1e3, HAL_WDT_MS);
+    printf("wall clock   %.3f s  -> %.0f trips/s, %.0fx real time\n",
+           wall, r.trips / wall, simulated / wall);
+    return r.lost || log_bad || wdt_gap_us > HAL_WDT_MS * 1000ULL;
+}
@@ -0,0 +1,494 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : footprint.c   — flash / RAM footprint from the linker output
+ * Purpose  : Read the GNU ld map and the ELF of each board, break the
+ *            footprint down per module and per symbol, point out the
+ *            biggest contributors and check them against budgets.
+ * Licence  : MIT
+ *
+ *   footprint [-b budgets] [-n top] [-s] board=path/Project [board=...]
+ *
+ *   board=path   reads path.map and path.elf (the Microchip Studio
+ *                output, e.g. Project_MEGA/Project_MEGA/Debug/Project_MEGA)
+ *   -b           budget file; exit 1 if anything is over (see
+ *                footprint.budget for the format)
+ *   -n           modules and symbols listed per board (default 12)
+ *   -s           totals only, one line per board (profile reports)
+ *
+ * flash = .text + .data (its initial values), RAM = .data + .bss +
+ * .noinit; the stack comes on top (stack.h measures it at run time).
+ * Toolchain objects are shown as archive(member) with the chain of
+ * references that pulled them in, e.g. why vfprintf is linked.
+ ***********************************************************************/
+#define _DEFAULT_SOURCE
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_BOARDS   4
+#define MAX_MODULES  128
+#define MAX_INSECS   2048
+#define MAX_SYMS     2048
+#define MAX_REASONS  128
+#define MAX_BUDGETS  64
+#define NAME_LEN     64
+#define LINE_LEN     1024
+
+enum { SEC_TEXT, SEC_DATA, SEC_BSS, SEC_COUNT };
+
+typedef struct {
+    char     name[NAME_LEN];
+    uint32_t size[SEC_COUNT];
+} module_t;
+
+typedef struct {                       /* one input section         */
+    uint32_t addr, size;
+    int      sec, module;
+} insec_t;
+
+typedef struct {
+    char     name[NAME_LEN];
+    uint32_t size;
+    int      sec, module;
+} sym_t;
+
+typedef struct {                       /* archive member → by whom  */
+    char member[NAME_LEN], by[NAME_LEN], sym[NAME_LEN];
+} reason_t;
+
+typedef struct {
+    char     name[16];
+    uint32_t out[SEC_COUNT];           /* output section sizes      */
+    uint32_t flash_len, ram_len;       /* Memory Configuration      */
+    module_t mod[MAX_MODULES];
+    int      n_mod;
+    insec_t  in[MAX_INSECS];
+    int      n_in;
+    sym_t    sym[MAX_SYMS];
+    int      n_sym;
+    reason_t why[MAX_REASONS];
+    int      n_why;
+} board_t;
+
+typedef struct {
+    char     board[16], what[NAME_LEN];
+    uint32_t limit;
+} budget_t;
+
+static board_t  boards[MAX_BOARDS];
+static int      n_boards;
+static budget_t budgets[MAX_BUDGETS];
+static int      n_budgets;
+
+/*----------------------------------------------------------------------
+  Names
+  --------------------------------------------------------------------*/
+/* ".../avr6\libc.a(vfprintf_std.o)" → "libc.a(vfprintf_std.o)",
+   "C:/.../crtatmega2560.o" → "crtatmega2560.o"                    */
+static void module_name(const char *path, char *out)
+{
+    const char *paren = 0;             /* "lib.a(" but not " (x86)" */
+    for (const char *p = path + 1; *p; p++)
+        if (*p == '(' && p[-1] != ' ') paren = p;
+    const char *end   = paren ? paren : path + strlen(path);
+    const char *base  = path;
+    for (const char *p = path; p < end; p++)
+        if (*p == '/' || *p == '\\') base = p + 1;
+    snprintf(out, NAME_LEN, "%s", base);
+    size_t n = strlen(out);
+    while (n && isspace((unsigned char)out[n - 1])) out[--n] = '\0';
+}
+
+static int is_lib(const char *m)
+{
+    return strchr(m, '(') != NULL;
+}
+
+static int module_id(board_t *b, const char *path)
+{
+    char name[NAME_LEN];
+    module_name(path, name);
+    for (int i = 0; i < b->n_mod; i++)
+        if (!strcmp(b->mod[i].name, name)) return i;
+    if (b->n_mod == MAX_MODULES) { fprintf(stderr, "footprint: too many modules\n"); exit(2); }
+    memset(&b->mod[b->n_mod], 0, sizeof b->mod[0]);
+    strcpy(b->mod[b->n_mod].name, name);
+    return b->n_mod++;
+}
+
+static int out_sec(const char *name)
+{
+    if (!strcmp(name, ".text")) return SEC_TEXT;
+    if (!strcmp(name, ".data")) return SEC_DATA;
+    if (!strcmp(name, ".bss") || !strcmp(name, ".noinit")) return SEC_BSS;
+    return -1;
+}
+
+/*----------------------------------------------------------------------
+  Map file
+  --------------------------------------------------------------------*/
+static void add_insec(board_t *b, int sec, uint32_t addr, uint32_t size, const char *file)
+{
+    const int m = module_id(b, file);
+    b->mod[m].size[sec] += size;
+    if (b->n_in < MAX_INSECS)
+        b->in[b->n_in++] = (insec_t){ addr, size, sec, m };
+}
+
+static void read_map(board_t *b, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); exit(2); }
+
+    enum { P_NONE, P_ARCHIVE, P_MEMORY, P_LAYOUT } part = P_NONE;
+    char line[LINE_LEN];
+    int  sec = -1, have_pending = 0;
+
+    while (fgets(line, sizeof line, f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if (!strncmp(line, "Archive member included", 23)) { part = P_ARCHIVE; continue; }
+        if (!strncmp(line, "Memory Configuration", 20))    { part = P_MEMORY;  continue; }
+        if (!strncmp(line, "Linker script and memory map", 28)) { part = P_LAYOUT; continue; }
+        if (!strncmp(line, "Discarded input sections", 24)) { part = P_NONE;  continue; }
+
+        if (part == P_ARCHIVE) {
+            if (line[0] && !isspace((unsigned char)line[0])) {
+                if (b->n_why < MAX_REASONS) {
+                    module_name(line, b->why[b->n_why].member);
+                    b->why[b->n_why].by[0] = '\0';
+                    b->n_why++;
+                }
+            } else if (line[0] && b->n_why) {
+                /* "    by/file.o (symbol)" */
+                reason_t *r = &b->why[b->n_why - 1];
+                char *open = strrchr(line, '(');
+                if (open && open > line && open[-1] == ' ') {
+                    char *close = strchr(open, ')');
+                    if (close) *close = '\0';
+                    snprintf(r->sym, NAME_LEN, "%s", open + 1);
+                    open[-1] = '\0';
+                }
+                char *s = line;
+                while (isspace((unsigned char)*s)) s++;
+                module_name(s, r->by);
+            }
+            continue;
+        }
+
+        if (part == P_MEMORY) {
+            char name[32];
+            unsigned long org, len;
+            if (sscanf(line, "%31s 0x%lx 0x%lx", name, &org, &len) == 3) {
+                if (!strcmp(name, "text")) b->flash_len = (uint32_t)len;
+                if (!strcmp(name, "data")) b->ram_len   = (uint32_t)len;
+            }
+            continue;
+        }
+
+        if (part != P_LAYOUT) continue;
+
+        /* Output section: ".text  0x00000000  0xe7a" at column 0 */
+        if (line[0] == '.') {
+            char name[64];
+            unsigned long addr, size;
+            const int n = sscanf(line, "%63s 0x%lx 0x%lx", name, &addr, &size);
+            sec = out_sec(name);
+            if (n == 3 && sec >= 0) b->out[sec] += (uint32_t)size;
+            have_pending = 0;
+            continue;
+        }
+        if (sec < 0) continue;
+
+        /* Input section, on one line or with its name on the line before */
+        char *s = line;
+        if (have_pending) {
+            unsigned long addr, size;
+            char file[LINE_LEN];
+            have_pending = 0;
+            if (sscanf(s, " 0x%lx 0x%lx %1023[^\n]", &addr, &size, file) == 3 && size) {
+                add_insec(b, sec, (uint32_t)addr, (uint32_t)size, file);
+                continue;
+            }
+        }
+        if (s[0] != ' ' || (s[1] != '.' && strncmp(s + 1, "COMMON", 6) && strncmp(s + 1, "*fill*", 6)))
+            continue;
+
+        char name[LINE_LEN], file[LINE_LEN];
+        unsigned long addr, size;
+        const int n = sscanf(s, " %1023s 0x%lx 0x%lx %1023[^\n]", name, &addr, &size, file);
+        if (n == 1) {                              /* name only */
+            have_pending = 1;
+        } else if (n == 3 && !strcmp(name, "*fill*") && size) {
+            add_insec(b, sec, (uint32_t)addr, (uint32_t)size, "(fill)");
+        } else if (n == 4 && size) {
+            add_insec(b, sec, (uint32_t)addr, (uint32_t)size, file);
+        }
+    }
+    fclose(f);
+}
+
+/*----------------------------------------------------------------------
+  ELF (32-bit little-endian, as avr-gcc writes it)
+  --------------------------------------------------------------------*/
+static uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t rd32(const uint8_t *p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+
+static int module_at(const board_t *b, int sec, uint32_t addr)
+{
+    for (int i = 0; i < b->n_in; i++)
+        if (b->in[i].sec == sec && addr >= b->in[i].addr && addr < b->in[i].addr + b->in[i].size)
+            return b->in[i].module;
+    return -1;
+}
+
+static void read_elf(board_t *b, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); exit(2); }
+    fseek(f, 0, SEEK_END);
+    const long len = ftell(f);
+    rewind(f);
+    uint8_t *img = malloc((size_t)len);
+    if (!img || fread(img, 1, (size_t)len, f) != (size_t)len) { perror(path); exit(2); }
+    fclose(f);
+
+    if (len < 52 || memcmp(img, "\177ELF", 4) || img[4] != 1 || img[5] != 1) {
+        fprintf(stderr, "footprint: %s is not a 32-bit little-endian ELF\n", path);
+        exit(2);
+    }
+    const uint32_t shoff  = rd32(img + 32);
+    const uint16_t shsize = rd16(img + 46), shnum = rd16(img + 48), shstr = rd16(img + 50);
+    if (shoff + (uint64_t)shsize * shnum > (uint64_t)len || shstr >= shnum) {
+        fprintf(stderr, "footprint: %s: bad section table\n", path);
+        exit(2);
+    }
+#define SH(i) (img + shoff + (uint32_t)(i) * shsize)
+    const char *shnames = (const char *)img + rd32(SH(shstr) + 16);
+
+    for (int i = 0; i < shnum; i++) {
+        if (rd32(SH(i) + 4) != 2) continue;                 /* SHT_SYMTAB */
+        const uint8_t *symtab = img + rd32(SH(i) + 16);
+        const uint32_t n      = rd32(SH(i) + 20) / 16;
+        const char    *strtab = (const char *)img + rd32(SH(rd32(SH(i) + 24)) + 16);
+
+        for (uint32_t k = 0; k < n; k++) {
+            const uint8_t *s    = symtab + k * 16;
+            const uint32_t size = rd32(s + 8);
+            const uint8_t  type = s[12] & 0x0F;
+            const uint16_t ndx  = rd16(s + 14);
+            if (!size || type > 2 || ndx == 0 || ndx >= shnum) continue;  /* NOTYPE/OBJECT/FUNC */
+            const int sec = out_sec(shnames + rd32(SH(ndx)));
+            if (sec < 0 || b->n_sym == MAX_SYMS) continue;
+
+            sym_t *y = &b->sym[b->n_sym++];
+            snprintf(y->name, NAME_LEN, "%s", strtab + rd32(s));
+            y->size   = size;
+            y->sec    = sec;
+            y->module = module_at(b, sec, rd32(s + 4));
+        }
+    }
+#undef SH
+    free(img);
+}
+
+/*----------------------------------------------------------------------
+  Budgets
+  --------------------------------------------------------------------*/
+static void read_budgets(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); exit(2); }
+    char line[LINE_LEN];
+    int  ln = 0;
+    while (fgets(line, sizeof line, f)) {
+        ln++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        budget_t g;
+        unsigned long limit;
+        const int n = sscanf(line, "%15s %63s %lu", g.board, g.what, &limit);
+        if (n <= 0) continue;
+        if (n != 3 || n_budgets == MAX_BUDGETS) {
+            fprintf(stderr, "%s:%d: expected '<board> <flash|ram|module> <bytes>'\n", path, ln);
+            exit(2);
+        }
+        g.limit = (uint32_t)limit;
+        budgets[n_budgets++] = g;
+    }
+    fclose(f);
+}
+
+/* Returns 1 if over budget; prints the budget column either way */
+static int check(const char *board, const char *what, uint32_t used)
+{
+    for (int i = 0; i < n_budgets; i++) {
+        if (strcmp(budgets[i].board, board) || strcmp(budgets[i].what, what)) continue;
+        const uint32_t lim = budgets[i].limit;
+        printf(" %8u  %5.1f %%%s", lim, lim ? 100.0 * used / lim : 0.0,
+               used > lim ? "  OVER BUDGET" : "");
+        return used > lim;
+    }
+    printf(" %8s", "-");
+    return 0;
+}
+
+/*----------------------------------------------------------------------
+  Report
+  --------------------------------------------------------------------*/
+static const board_t *cur;
+
+static uint32_t mod_flash(const module_t *m) { return m->size[SEC_TEXT] + m->size[SEC_DATA]; }
+
+static int by_flash(const void *a, const void *b)
+{
+    const uint32_t x = mod_flash(&cur->mod[*(const int *)a]);
+    const uint32_t y = mod_flash(&cur->mod[*(const int *)b]);
+    return (x < y) - (x > y);
+}
+
+static int by_ram(const void *a, const void *b)
+{
+    const module_t *x = &cur->mod[*(const int *)a], *y = &cur->mod[*(const int *)b];
+    const uint32_t rx = x->size[SEC_DATA] + x->size[SEC_BSS], ry = y->size[SEC_DATA] + y->size[SEC_BSS];
+    return (rx < ry) - (rx > ry);
+}
+
+static int by_size(const void *a, const void *b)
+{
+    const sym_t *x = a, *y = b;
+    return (x->size < y->size) - (x->size > y->size);
+}
+
+/* "libc.a(sprintf.o) (vfprintf) <- main.o (sprintf)" */
+static void print_chain(const board_t *b, const char *member)
+{
+    for (int depth = 0; depth < 8; depth++) {
+        const reason_t *r = 0;
+        for (int i = 0; i < b->n_why && !r; i++)
+            if (!strcmp(b->why[i].member, member)) r = &b->why[i];
+        if (!r) return;
+        printf(" <- %s (%s)", r->by, r->sym);
+        if (!is_lib(r->by)) return;
+        member = r->by;
+    }
+}
+
+static int report(board_t *b, int top)
+{
+    int over = 0;
+    cur = b;
+
+    const uint32_t flash = b->out[SEC_TEXT] + b->out[SEC_DATA];
+    const uint32_t ram   = b->out[SEC_DATA] + b->out[SEC_BSS];
+
+    printf("== %s\n", b->name);
+    printf("region      used   device   budget\n");
+    printf("flash   %8u %8u", flash, b->flash_len);
+    over |= check(b->name, "flash", flash);
+    printf("\nram     %8u %8u", ram, b->ram_len);
+    over |= check(b->name, "ram", ram);
+    printf("\n        (.text %u, .data %u, .bss %u; stack not included)\n",
+           b->out[SEC_TEXT], b->out[SEC_DATA], b->out[SEC_BSS]);
+
+    int order[MAX_MODULES];
+    for (int i = 0; i < b->n_mod; i++) order[i] = i;
+
+    /* Modules by flash; a budget line per module is checked too */
+    qsort(order, (size_t)b->n_mod, sizeof order[0], by_flash);
+    printf("\n%-32s %6s %6s %6s %6s\n", "module", "text", "data", "bss", "flash");
+    for (int k = 0; k < b->n_mod; k++) {
+        const module_t *m = &b->mod[order[k]];
+        int has_budget = 0;
+        for (int i = 0; i < n_budgets; i++)
+            has_budget |= !strcmp(budgets[i].board, b->name) && !strcmp(budgets[i].what, m->name);
+        if (k >= top && !has_budget) continue;
+        printf("%-32s %6u %6u %6u %6u", m->name, m->size[SEC_TEXT], m->size[SEC_DATA],
+               m->size[SEC_BSS], mod_flash(m));
+        if (has_budget) over |= check(b->name, m->name, mod_flash(m));
+        if (is_lib(m->name)) print_chain(b, m->name);
+        printf("\n");
+    }
+    if (b->n_mod > top) printf("(%d more)\n", b->n_mod - top);
+
+    qsort(order, (size_t)b->n_mod, sizeof order[0], by_ram);
+    printf("\n%-32s %6s %6s\n", "module by RAM", "data", "bss");
+    for (int k = 0; k < b->n_mod && k < top; k++) {
+        const module_t *m = &b->mod[order[k]];
+        if (!m->size[SEC_DATA] && !m->size[SEC_BSS]) break;
+        printf("%-32s %6u %6u\n", m->name, m->size[SEC_DATA], m->size[SEC_BSS]);
+    }
+
+    /* Symbols, per output section */
+    qsort(b->sym, (size_t)b->n_sym, sizeof b->sym[0], by_size);
+    for (int sec = 0; sec < SEC_COUNT; sec++) {
+        printf("\n%-32s %6s  %s\n", sec == SEC_TEXT ? "symbol (.text)" :
+               sec == SEC_DATA ? "symbol (.data)" : "symbol (.bss)", "size", "module");
+        int shown = 0;
+        for (int i = 0; i < b->n_sym && shown < top; i++) {
+            if (b->sym[i].sec != sec) continue;
+            printf("%-32s %6u  %s\n", b->sym[i].name, b->sym[i].size,
+                   b->sym[i].module >= 0 ? b->mod[b->sym[i].module].name : "?");
+            shown++;
+        }
+        if (!shown) printf("(none)\n");
+    }
+    printf("\n");
+    return over;
+}
+
+/* "mega  flash 12345 / 262144  ram 678 / 8192" (+ budgets)     */
+static int summary(const board_t *b)
+{
+    const uint32_t flash = b->out[SEC_TEXT] + b->out[SEC_DATA];
+    const uint32_t ram   = b->out[SEC_DATA] + b->out[SEC_BSS];
+    int over = 0;
+
+    printf("%-6s flash %6u / %-6u", b->name, flash, b->flash_len);
+    over |= check(b->name, "flash", flash);
+    printf("   ram %5u / %-5u", ram, b->ram_len);
+    over |= check(b->name, "ram", ram);
+    printf("\n");
+    return over;
+}
+
+int main(int argc, char **argv)
+{
+    int top = 12, brief = 0, opt;
+
+    while ((opt = getopt(argc, argv, "b:n:s")) != -1) {
+        switch (opt) {
+        case 'b': read_budgets(optarg);  break;
+        case 'n': top = atoi(optarg);    break;
+        case 's': brief = 1;             break;
+        default:  goto usage;
+        }
+    }
+    if (optind == argc) goto usage;
+
+    int over = 0;
+    for (int i = optind; i < argc; i++) {
+        const char *eq = strchr(argv[i], '=');
+        if (!eq || eq == argv[i] || (size_t)(eq - argv[i]) >= sizeof boards[0].name || n_boards == MAX_BOARDS)
+            goto usage;
+        board_t *b = &boards[n_boards++];
+        memset(b, 0, sizeof *b);
+        memcpy(b->name, argv[i], (size_t)(eq - argv[i]));
+
+        char path[LINE_LEN];
+        snprintf(path, sizeof path, "%s.map", eq + 1);
+        read_map(b, path);
+        snprintf(path, sizeof path, "%s.elf", eq + 1);
+        read_elf(b, path);
+        over |= brief ? summary(b) : report(b, top);
+    }
+    if (over) printf("footprint: over budget\n");
+    return over;
+
+usage:
+    fprintf(stderr, "usage: %s [-b budgets] [-n top] [-s] board=path/Project ...\n", argv[0]);
+    return 2;
+}
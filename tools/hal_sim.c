@@ -0,0 +1,291 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : hal_sim.c   — hal.h and telemetry.h on Linux (see hal_sim.h)
+ * Licence  : MIT
+ ***********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal.h"
+#include "hal_sim.h"
+#include "protocol.h"
+#include "telemetry.h"
+
+/* One simulated board per thread (tools/sweep runs them in parallel) */
+__thread sim_t sim;
+
+static __thread uint8_t  emg_flag;
+static __thread uint16_t emg_stamp;
+
+/* Minimal UNO: reply buffer for queries, as in Project_UNO main.c */
+static __thread uint8_t  reply[POWER_STATS_LEN];
+static __thread uint8_t  reply_len, reply_pos;
+
+static __thread uint8_t  eeprom[SIM_EEPROM_SIZE];
+static __thread uint32_t nv_cell[SIM_EEPROM_SIZE];  /* writes per cell */
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;         p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+void sim_reset(sim_key_fn user_key, sim_tlm_fn on_tlm, void *ctx)
+{
+    cal_free(&sim.cal);
+    memset(&sim, 0, sizeof sim);
+    cal_init(&sim.cal);
+    sim.user_key   = user_key;
+    sim.on_tlm     = on_tlm;
+    sim.ctx        = ctx;
+    sim.uno_status = STATUS_READY;                  /* answering     */
+    memset(eeprom, 0xFF, sizeof eeprom);            /* erased        */
+    memset(nv_cell, 0, sizeof nv_cell);
+    sim_reboot(HAL_RESET_POWER);
+}
+
+void sim_reboot(uint8_t cause)
+{
+    memset(sim.lcd, ' ', sizeof sim.lcd);
+    sim.lcd[0][16] = sim.lcd[1][16] = '\0';
+    sim.lcd_x = sim.lcd_y = 0;
+    sim.reset_cause = cause;
+    sim.boot_us     = sim.now_us;                   /* Timer-1 at 0  */
+    sim.wdt_kick_us = sim.now_us;
+    emg_flag  = 0;
+    reply_len = reply_pos = 0;
+}
+
+/* --- event calendar ------------------------------------------------ */
+void sim_at(uint64_t at_us, cal_fn fn, uint64_t arg)
+{
+    cal_push(&sim.cal, at_us < sim.now_us ? sim.now_us : at_us, fn, sim.ctx, arg);
+}
+
+/* Fire, at its own time, every event due by *until*; end at *until* */
+static void run_until(uint64_t until)
+{
+    cal_event_t ev;
+
+    if (sim.tick_us) {                         /* one tick at a time */
+        while (sim.now_us < until) {
+            uint64_t step = sim.tick_us - sim.now_us % sim.tick_us;
+            if (step > until - sim.now_us) step = until - sim.now_us;
+            sim.now_us += step;
+            sim.steps++;
+            while (cal_peek(&sim.cal) && cal_peek(&sim.cal)->at_us <= sim.now_us) {
+                cal_pop(&sim.cal, &ev);
+                ev.fn(ev.ctx, ev.arg);
+            }
+        }
+        return;
+    }
+    while (cal_peek(&sim.cal) && cal_peek(&sim.cal)->at_us <= until) {
+        cal_pop(&sim.cal, &ev);
+        if (ev.at_us > sim.now_us) {
+            sim.now_us = ev.at_us;
+            sim.steps++;
+        }
+        ev.fn(ev.ctx, ev.arg);
+    }
+    if (until > sim.now_us) {
+        sim.now_us = until;
+        sim.steps++;
+    }
+}
+
+void sim_advance(uint64_t us)
+{
+    run_until(sim.now_us + us);
+}
+
+int sim_next(void)
+{
+    const cal_event_t *e = cal_peek(&sim.cal);
+    if (!e) return 0;
+    run_until(sim.tick_us ? sim.now_us + sim.tick_us - sim.now_us % sim.tick_us : e->at_us);
+    return 1;
+}
+
+void sim_emg_press(void)
+{
+    if (emg_flag) return;                      /* already latched    */
+    emg_flag  = 1;
+    emg_stamp = tlm_now();
+}
+
+/* --- hal.h ---------------------------------------------------------- */
+void hal_init(void) { }
+
+/* The board kicks the watchdog all through a wait: the gap starts
+   over at its end                                                 */
+static void waited(void)
+{
+    sim.wdt_kick_us = sim.now_us;
+}
+
+/* Same 10 ms quantisation as the Timer-1 tick on the board */
+void hal_wait_ms(uint16_t ms)
+{
+    const uint64_t tick   = 10000;
+    const uint64_t target = (sim.now_us / tick + ms / 10) * tick;
+    hal_wdt_kick();
+    if (target > sim.now_us) sim_advance(target - sim.now_us);
+    waited();
+}
+
+/* Nobody at the keypad: skip to whatever happens next */
+char hal_key_get(void)
+{
+    hal_wdt_kick();
+    for (;;) {
+        uint32_t think_ms = 0;
+        const char key = sim.user_key(sim.ctx, &think_ms);
+        if (key) {
+            sim_advance((uint64_t)think_ms * 1000);
+            waited();
+            return key;
+        }
+        if (!sim_next()) {
+            fprintf(stderr, "hal_sim: keypad wait with nothing on the calendar\n");
+            exit(2);
+        }
+    }
+}
+
+void hal_lcd_clear(void)
+{
+    memset(sim.lcd[0], ' ', 16);
+    memset(sim.lcd[1], ' ', 16);
+    sim.lcd_x = sim.lcd_y = 0;
+    sim_advance(SIM_LCD_CLEAR_US);
+}
+
+void hal_lcd_gotoxy(uint8_t x, uint8_t y)
+{
+    sim.lcd_x = x;
+    sim.lcd_y = y & 1;
+    sim_advance(SIM_LCD_CHAR_US);
+}
+
+void hal_lcd_putc(char c)
+{
+    if (sim.lcd_x < 16) sim.lcd[sim.lcd_y][sim.lcd_x] = c;
+    sim.lcd_x++;
+    sim_advance(SIM_LCD_CHAR_US);
+}
+
+void hal_lcd_puts(const char *s)
+{
+    while (*s) hal_lcd_putc(*s++);
+}
+
+void hal_spi_frame(const uint8_t *b, uint8_t n)
+{
+    sim.spi_frames++;
+    sim.spi_ops[b[0]]++;
+    sim_advance((uint64_t)n * SIM_SPI_BYTE_US + (uint64_t)(n - 1) * SIM_SPI_GAP_US);
+
+    reply_len = reply_pos = 0;
+    if (b[0] == CMD_POWER_STATS) {            /* uptime; never asleep */
+        put32(&reply[0], (uint32_t)(sim.now_us / 64));
+        put32(&reply[4], 0);
+        put32(&reply[8], 0);
+        reply_len = POWER_STATS_LEN;
+    }
+}
+
+uint8_t hal_spi_reply(uint8_t b)
+{
+    sim_advance(SIM_SPI_GAP_US + SIM_SPI_BYTE_US);
+    if (b == CMD_READ)
+        return reply_pos < reply_len ? reply[reply_pos++] : 0;
+    reply_len = reply_pos = 0;
+    return b == CMD_STATUS ? sim.uno_status : 0;
+}
+
+/* No painted RAM on the host */
+void     hal_stack_stats(uint8_t *p) { memset(p, 0, STACK_STATS_LEN); }
+
+uint8_t hal_emg_pending(void)
+{
+    if (sim.emg_poll && sim.emg_poll(sim.ctx) && !emg_flag) {
+        emg_flag  = 1;
+        emg_stamp = tlm_now();
+    }
+    return emg_flag;
+}
+
+uint16_t hal_emg_stamp(void)   { return emg_stamp; }
+void     hal_emg_clear(void)   { emg_flag = 0; }
+
+uint8_t  hal_reset_cause(void) { return sim.reset_cause; }
+
+void hal_wdt_kick(void)
+{
+    const uint64_t gap = sim.now_us - sim.wdt_kick_us;
+    if (gap > sim.wdt_gap_us) sim.wdt_gap_us = gap;
+    sim.wdt_kick_us = sim.now_us;
+}
+
+void hal_nv_read(uint16_t addr, void *p, uint8_t n)
+{
+    memcpy(p, &eeprom[addr % SIM_EEPROM_SIZE], n);
+}
+
+void hal_nv_update(uint16_t addr, const void *p, uint8_t n)
+{
+    const uint8_t *b = p;
+    for (uint8_t i = 0; i < n; i++, addr++) {
+        uint8_t *cell = &eeprom[addr % SIM_EEPROM_SIZE];
+        if (*cell != b[i]) {
+            *cell = b[i];
+            sim.nv_writes++;
+            nv_cell[addr % SIM_EEPROM_SIZE]++;
+        }
+    }
+}
+
+/* hal_nv_update() is synchronous here: nothing is ever queued */
+void hal_nv_flush(void) { }
+
+void sim_nv_tear(uint16_t addr)
+{
+    eeprom[addr % SIM_EEPROM_SIZE] ^= 0xA5;
+}
+
+uint32_t sim_nv_hottest(uint16_t *addr)
+{
+    uint16_t hot = 0;
+    for (uint16_t a = 1; a < SIM_EEPROM_SIZE; a++)
+        if (nv_cell[a] > nv_cell[hot]) hot = a;
+    if (addr) *addr = hot;
+    return nv_cell[hot];
+}
+
+/* --- telemetry.h ---------------------------------------------------- */
+void tlm_init(void)
+{
+    tlm_emit(TLM_BOOT, 0, 0);
+}
+
+uint16_t tlm_now(void)
+{
+    return (uint16_t)((sim.now_us - sim.boot_us) / TLM_COUNT_US);
+}
+
+void tlm_flush(void) { }
+
+/* Nothing is ever dropped here */
+void tlm_emit_wait(uint8_t type, const uint8_t *payload, uint8_t len)
+{
+    tlm_emit(type, payload, len);
+}
+
+void tlm_emit(uint8_t type, const uint8_t *payload, uint8_t len)
+{
+    if (len > TLM_MAX_PAYLOAD) len = TLM_MAX_PAYLOAD;
+    sim.tlm_records++;
+    if (sim.on_tlm) sim.on_tlm(sim.ctx, type, payload, len);
+}
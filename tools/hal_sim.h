@@ -0,0 +1,100 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : hal_sim.h   — hal.h on Linux: in-memory fakes, simulated time
+ * Licence  : MIT
+ *
+ * Nothing here sleeps.  Every HAL call that takes time on the board
+ * advances sim.now_us by a modelled cost instead, so a trip that
+ * takes ten seconds on the MEGA finishes in microseconds.
+ *
+ * Time is discrete-event: anything that happens on its own (a button
+ * press, a passenger arriving) is put on the event calendar with
+ * sim_at(), and waits jump from one event to the next instead of
+ * stepping through the 10 ms ticks in between.  With sim.tick_us set,
+ * time steps tick by tick instead, as a polled loop would; that is
+ * only there to measure what the jumps save.
+ *
+ *   keypad      blocks by calling sim.user_key(), which returns the
+ *               next key and how long the user thinks first, or 0 if
+ *               nobody is there: the wait then skips to the next event
+ *   LCD         16x2 character buffer, HD44780 command times
+ *   SPI         1 MHz byte time + 20 us slave gap; a minimal UNO
+ *               answers CMD_STATUS and CMD_POWER_STATS
+ *   emergency   sim_emg_press() from an event, or sim.emg_poll()
+ *               returning 1 (replay: on a given poll)
+ *   telemetry   tlm_emit() is counted and passed to sim.on_tlm()
+ *   EEPROM      4 KiB, erased by sim_reset() and kept by sim_reboot();
+ *               writes are done at once (no queue to flush) and take
+ *               no simulated time; each cell counts the
+ *               writes that changed it, for the wear figures
+ *   watchdog    never fires; sim.wdt_gap_us is the longest stretch
+ *               of FSM work between two kicks (a wait kicks all through),
+ *               to hold against HAL_WDT_MS
+ *
+ * All of this state is per thread, so separate threads can each run
+ * their own simulation.
+ ***********************************************************************/
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+#include <stdint.h>
+#include "calendar.h"
+
+/* Modelled costs, from the HD44780 datasheet and the SPI set-up */
+#define SIM_LCD_CLEAR_US    1530       /* clear display              */
+#define SIM_LCD_CHAR_US     45         /* data/command + busy poll   */
+#define SIM_SPI_BYTE_US     8          /* 8 bits at 1 MHz            */
+#define SIM_SPI_GAP_US      20         /* slave ISR between bytes    */
+#define SIM_EEPROM_SIZE     4096
+
+typedef char (*sim_key_fn)(void *ctx, uint32_t *think_ms);
+typedef void (*sim_tlm_fn)(void *ctx, uint8_t type,
+                           const uint8_t *payload, uint8_t len);
+typedef int  (*sim_poll_fn)(void *ctx);
+
+typedef struct {
+    uint64_t   now_us;                 /* simulated time since reset */
+
+    sim_key_fn user_key;               /* required                   */
+    sim_tlm_fn on_tlm;                 /* optional                   */
+    void      *ctx;                    /* passed to all three        */
+
+    sim_poll_fn emg_poll;              /* optional, per poll         */
+    uint8_t    uno_status;             /* CMD_STATUS reply           */
+
+    char       lcd[2][17];             /* NUL-terminated rows        */
+    uint8_t    lcd_x, lcd_y;
+
+    uint64_t   spi_frames;
+    uint64_t   spi_ops[256];           /* frames per opcode          */
+    uint64_t   tlm_records;
+
+    calendar_t cal;                    /* pending events             */
+    uint64_t   tick_us;                /* 0 = jump; else step by it  */
+    uint64_t   steps;                  /* jumps or ticks taken       */
+
+    uint8_t    reset_cause;            /* HAL_RESET_*                */
+    uint64_t   boot_us;                /* tlm_now() counts from here */
+    uint64_t   wdt_kick_us;            /* last kick                  */
+    uint64_t   wdt_gap_us;             /* longest time between kicks */
+    uint64_t   nv_writes;              /* EEPROM bytes written       */
+} sim_t;
+
+extern __thread sim_t sim;              /* one board per thread       */
+
+void sim_reset(sim_key_fn user_key, sim_tlm_fn on_tlm, void *ctx);
+void sim_advance(uint64_t us);         /* fires the events on the way */
+void sim_at(uint64_t at_us, cal_fn fn, uint64_t arg);  /* ctx = sim.ctx;
+                                          fn must not call the HAL  */
+int  sim_next(void);                   /* to the next event or tick;
+                                          0 = calendar empty        */
+void sim_emg_press(void);              /* latch INT4, stamped now    */
+void sim_reboot(uint8_t cause);        /* MEGA reset: RAM state, LCD
+                                          and latch lost; time, the
+                                          calendar and EEPROM kept  */
+uint32_t sim_nv_hottest(uint16_t *addr);  /* most-written cell since
+                                          sim_reset(): its writes   */
+void sim_nv_tear(uint16_t addr);       /* a write cut short there:
+                                          the cell holds garbage    */
+
+#endif /* HAL_SIM_H */
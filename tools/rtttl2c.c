@@ -0,0 +1,216 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : rtttl2c.c   — build-time RTTTL → flash note table compiler
+ * Purpose  : Turn RTTTL melodies into PROGMEM seq_note_t tables for the
+ *            UNO sequencer.  Pitches are emitted as NOTE_xx indices and
+ *            durations as SEQ_MS(ms), so every timer value is folded by
+ *            avr-gcc from F_CPU and the prescaler in use.
+ * Licence  : MIT
+ *
+ *   rtttl2c [-o melodies.h] melodies.rtttl
+ *
+ * One melody per line, "name:d=4,o=5,b=120:8c,d#,p,2g.6".  Lines that
+ * start with '#' and blank lines are ignored.  Supported octaves are
+ * 4..6 (notes.h); a note's duration is its sounding time, the
+ * sequencer appends SEQ_GAP_MS of silence after each note.  The
+ * output uses CRLF line endings like the rest of the firmware tree.
+ ***********************************************************************/
+#define _DEFAULT_SOURCE          /* open_memstream */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LINE   1024
+#define MAX_MS     4194          /* SEQ_MS() limit: 65535 * 64 us    */
+#define OCT_MIN    4
+#define OCT_MAX    6
+
+static const char *const note_names[12] = {
+    "C", "CS", "D", "DS", "E", "F", "FS", "G", "GS", "A", "AS", "B"
+};
+
+static const char *src_name;
+static int         src_line;
+
+static void die(const char *msg, const char *at)
+{
+    fprintf(stderr, "%s:%d: %s", src_name, src_line, msg);
+    if (at) fprintf(stderr, " near \"%.12s\"", at);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+static const char *skip_ws(const char *p)
+{
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+static int valid_duration(long d)
+{
+    return d == 1 || d == 2 || d == 4 || d == 8 || d == 16 || d == 32;
+}
+
+/* Parse "d=4,o=5,b=120" into the defaults. */
+static void parse_defaults(const char *p, const char *end, long *dur, long *oct, long *bpm)
+{
+    while (p < end) {
+        p = skip_ws(p);
+        if (p >= end) break;
+        const char key = (char)tolower((unsigned char)*p);
+        p = skip_ws(p + 1);
+        if (*p != '=') die("expected '=' in defaults", p);
+        char *e;
+        const long v = strtol(p + 1, &e, 10);
+        if (e == p + 1) die("expected a number in defaults", p);
+        switch (key) {
+        case 'd': if (!valid_duration(v)) die("bad default duration", p); *dur = v; break;
+        case 'o': *oct = v; break;
+        case 'b': if (v <= 0 || v > 900) die("bad tempo", p); *bpm = v; break;
+        default:  die("unknown default", p - 1);
+        }
+        p = skip_ws(e);
+        if (*p == ',') p++;
+    }
+}
+
+/* Emit one melody line as a PROGMEM table. */
+static void compile_line(FILE *out, char *line)
+{
+    line[strcspn(line, "\r\n")] = 0;
+
+    char *c1 = strchr(line, ':');
+    char *c2 = c1 ? strchr(c1 + 1, ':') : NULL;
+    if (!c2) die("expected name:defaults:notes", line);
+
+    /* name → C identifier */
+    char ident[64];
+    size_t n = 0;
+    for (const char *p = line; p < c1 && n < sizeof ident - 1; p++) {
+        const unsigned char ch = (unsigned char)*p;
+        if (isalnum(ch)) ident[n++] = (char)tolower(ch);
+        else if (n && ident[n - 1] != '_') ident[n++] = '_';
+    }
+    while (n && ident[n - 1] == '_') n--;
+    ident[n] = 0;
+    if (!n) die("empty melody name", line);
+
+    long dur = 4, oct = 6, bpm = 63;            /* RTTTL defaults */
+    parse_defaults(c1 + 1, c2, &dur, &oct, &bpm);
+
+    fprintf(out, "/* %s */\n", line);
+    fprintf(out, "static const seq_note_t melody_%s[] PROGMEM = {\n", ident);
+
+    const char *p = c2 + 1;
+    int count = 0;
+    long total_ms = 0;
+
+    for (;;) {
+        p = skip_ws(p);
+        if (!*p) break;
+
+        char *e;
+        long d = strtol(p, &e, 10);
+        if (e == p) d = dur;
+        else if (!valid_duration(d)) die("bad duration", p);
+        p = e;
+
+        const char letter = (char)tolower((unsigned char)*p);
+        int semi;
+        switch (letter) {
+        case 'c': semi = 0;  break;
+        case 'd': semi = 2;  break;
+        case 'e': semi = 4;  break;
+        case 'f': semi = 5;  break;
+        case 'g': semi = 7;  break;
+        case 'a': semi = 9;  break;
+        case 'b': case 'h': semi = 11; break;
+        case 'p': semi = -1; break;
+        default:  die("expected a note letter", p);
+        }
+        p++;
+        if (*p == '#') { if (semi < 0) die("sharp on a pause", p); semi++; p++; }
+
+        int dotted = 0;
+        if (*p == '.') { dotted = 1; p++; }
+        long o = oct;
+        if (isdigit((unsigned char)*p)) { o = *p - '0'; p++; }
+        if (*p == '.') { dotted = 1; p++; }
+
+        p = skip_ws(p);
+        if (*p == ',') p++;
+        else if (*p) die("expected ','", p);
+
+        /* whole note = 4 beats */
+        long ms = (240000L * (dotted ? 3 : 2) / (bpm * d) + 1) / 2;
+        if (ms > MAX_MS) die("note longer than the sequencer allows", NULL);
+        total_ms += ms;
+
+        fprintf(out, count == 0 ? "    " : count % 4 == 0 ? "\n    " : " ");
+        if (semi < 0) {
+            fprintf(out, "SEQ_REST(%ld),", ms);
+        } else {
+            if (semi == 12) { semi = 0; o++; }      /* b# → next C */
+            if (o < OCT_MIN || o > OCT_MAX) die("octave outside notes.h (4..6)", NULL);
+            fprintf(out, "SEQ_NOTE(%s%ld, %ld),", note_names[semi], o, ms);
+        }
+        count++;
+    }
+    if (!count) die("melody has no notes", NULL);
+    fprintf(out, "\n    SEQ_END\n};   /* %d note%s, %ld ms + gaps */\n\n",
+            count, count == 1 ? "" : "s", total_ms);
+}
+
+int main(int argc, char **argv)
+{
+    const char *out_path = NULL;
+    int i = 1;
+
+    if (argc > 2 && !strcmp(argv[1], "-o")) { out_path = argv[2]; i = 3; }
+    if (i != argc - 1) {
+        fprintf(stderr, "usage: %s [-o melodies.h] melodies.rtttl\n", argv[0]);
+        return 2;
+    }
+    src_name = argv[i];
+
+    FILE *in = fopen(src_name, "r");
+    if (!in) { perror(src_name); return 1; }
+
+    /* write to a buffer first so a parse error leaves no half file */
+    char  *buf = NULL;
+    size_t len = 0;
+    FILE  *out = open_memstream(&buf, &len);
+    if (!out) { perror("open_memstream"); return 1; }
+
+    fprintf(out,
+        "/*************************************************************\n"
+        " * melodies.h  — generated by tools/rtttl2c from melodies.rtttl\n"
+        " *               Do not edit; run `make -C tools melodies`.\n"
+        " *************************************************************/\n"
+        "#ifndef MELODIES_H\n"
+        "#define MELODIES_H\n\n"
+        "#include <avr/pgmspace.h>\n"
+        "#include \"sequencer.h\"\n\n");
+
+    char line[MAX_LINE];
+    while (fgets(line, sizeof line, in)) {
+        src_line++;
+        const char *p = skip_ws(line);
+        if (*p == '#' || *p == '\n' || *p == '\r' || !*p) continue;
+        compile_line(out, line);
+    }
+    fclose(in);
+    fprintf(out, "#endif /* MELODIES_H */\n");
+    fclose(out);
+
+    FILE *dst = out_path ? fopen(out_path, "w") : stdout;
+    if (!dst) { perror(out_path); return 1; }
+    for (size_t k = 0; k < len; k++) {
+        if (buf[k] == '\n') fputc('\r', dst);
+        fputc(buf[k], dst);
+    }
+    if (out_path) fclose(dst);
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,344 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : sweep.c   — timing and dispatch sweeps on every core
+ * Purpose  : Run the traffic workloads (workload.c) over a grid or a
+ *            random sample of controller settings and rank them by
+ *            waiting time, using all the host's cores.
+ * Licence  : MIT
+ *
+ *   sweep [-g name=lo:hi:step]... [-g policy=fcfs,nearest] [-R n]
+ *         [-n seeds] [-j threads] [-t top]
+ *         [-w workload] [-f floors] [-a per_hour] [-D hours]
+ *         [-c capacity] [-S seed]
+ *
+ *   -g   a swept setting: floor (FLOOR_TIME_MS), open (DOOR_OPEN_MS),
+ *        closed (DOOR_CLOSED_MS) from lo to hi in steps, or policy as
+ *        a list; a setting not named stays at its elevator.h value
+ *   -R   n settings drawn at random from the grid instead of all of it
+ *   -n   seeds per setting (default 5); every setting sees the same
+ *        passengers, so the ranking is not down to luck
+ *   -j   worker threads (default: one per online CPU)
+ *   -t   rows of the ranking to print (default 10)
+ *   -w .. -S   the workload, as for traffic (default inter, 10 floors,
+ *        60/h, 2 h, 8 passengers, seed 1)
+ *
+ * Each setting x seed is one task.  Runs differ a lot in cost (a slow
+ * car on a busy day runs longer), so the tasks are dealt out in blocks
+ * to per-thread deques and an idle thread steals from the far end of
+ * another's; the owner works from the near end.  Results go into a
+ * slot per task, so the workers share nothing else.
+ *
+ * The ranking is by mean waiting time over the seeds, then by mean
+ * p95 wait.  The last line gives the wall time and runs per second,
+ * to compare -j 1 with -j N.
+ ***********************************************************************/
+#define _POSIX_C_SOURCE 199309L
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "workload.h"
+
+enum { D_FLOOR, D_OPEN, D_CLOSED, D_POLICY, D_COUNT };
+static const char *const dim_names[D_COUNT] = { "floor", "open", "closed", "policy" };
+
+typedef struct {
+    unsigned n;
+    unsigned v[256];                   /* values, in grid order     */
+} dim_t;
+
+typedef struct {
+    unsigned v[D_COUNT];
+    double   wait_avg, wait_p95, journey_avg, hc5;
+    size_t   undelivered;
+} setting_t;
+
+/*----------------------------------------------------------------------
+  Work-stealing pool
+  --------------------------------------------------------------------*/
+typedef struct {
+    pthread_mutex_t lock;
+    size_t   *task;
+    size_t    top, bottom;             /* thieves take top, owner bottom */
+} deque_t;
+
+typedef struct {
+    const wl_params_t *base;
+    const setting_t   *set;
+    unsigned  seeds;
+    kpi_t    *result;                  /* one per task              */
+    deque_t  *dq;
+    unsigned  workers;
+} pool_t;
+
+typedef struct {
+    pool_t   *pool;
+    unsigned  id;
+    uint64_t  runs, steals;
+    pthread_t thread;
+} worker_t;
+
+static int pop_bottom(deque_t *d, size_t *t)
+{
+    int ok = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top) { *t = d->task[--d->bottom]; ok = 1; }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+static int steal_top(deque_t *d, size_t *t)
+{
+    int ok = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top) { *t = d->task[d->top++]; ok = 1; }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+/* Tasks never make tasks, so once every deque is empty the work is done */
+static int next_task(worker_t *w, size_t *t)
+{
+    pool_t *p = w->pool;
+    if (pop_bottom(&p->dq[w->id], t)) return 1;
+    for (unsigned i = 1; i < p->workers; i++)
+        if (steal_top(&p->dq[(w->id + i) % p->workers], t)) {
+            w->steals++;
+            return 1;
+        }
+    return 0;
+}
+
+static void *worker(void *arg)
+{
+    worker_t *w = arg;
+    pool_t   *p = w->pool;
+    size_t    t;
+
+    while (next_task(w, &t)) {
+        const setting_t *s = &p->set[t / p->seeds];
+        wl_params_t prm    = *p->base;
+        prm.floor_ms       = (uint16_t)s->v[D_FLOOR];
+        prm.door_open_ms   = (uint16_t)s->v[D_OPEN];
+        prm.door_closed_ms = (uint16_t)s->v[D_CLOSED];
+        prm.policy         = (int)s->v[D_POLICY];
+        prm.seed           = p->base->seed + t % p->seeds;
+        p->result[t] = workload_run(&prm);
+        w->runs++;
+    }
+    return 0;
+}
+
+/* Deal the tasks out in contiguous blocks, one per worker */
+static void run_pool(pool_t *p, size_t n_tasks, worker_t *w)
+{
+    p->dq = calloc(p->workers, sizeof *p->dq);
+    if (!p->dq) { fprintf(stderr, "sweep: out of memory\n"); exit(2); }
+
+    for (unsigned i = 0; i < p->workers; i++) {
+        const size_t lo = n_tasks * i / p->workers, hi = n_tasks * (i + 1) / p->workers;
+        deque_t *d = &p->dq[i];
+        pthread_mutex_init(&d->lock, 0);
+        d->task = malloc((hi - lo + 1) * sizeof *d->task);
+        if (!d->task) { fprintf(stderr, "sweep: out of memory\n"); exit(2); }
+        /* owner pops from the bottom: push in reverse so it runs lo first */
+        for (size_t t = hi; t > lo; t--) d->task[d->bottom++] = t - 1;
+        w[i].pool = p;
+        w[i].id   = i;
+    }
+    for (unsigned i = 0; i < p->workers; i++)
+        if (pthread_create(&w[i].thread, 0, worker, &w[i])) {
+            fprintf(stderr, "sweep: cannot start thread %u\n", i);
+            exit(2);
+        }
+    for (unsigned i = 0; i < p->workers; i++) pthread_join(w[i].thread, 0);
+
+    for (unsigned i = 0; i < p->workers; i++) {
+        pthread_mutex_destroy(&p->dq[i].lock);
+        free(p->dq[i].task);
+    }
+    free(p->dq);
+}
+
+/*----------------------------------------------------------------------
+  Settings
+  --------------------------------------------------------------------*/
+static int parse_dim(dim_t *dims, const char *arg)
+{
+    const char *eq = strchr(arg, '=');
+    if (!eq) return -1;
+    int d = -1;
+    for (int i = 0; i < D_COUNT; i++)
+        if ((size_t)(eq - arg) == strlen(dim_names[i]) && !strncmp(arg, dim_names[i], eq - arg))
+            d = i;
+    if (d < 0) return -1;
+
+    dim_t *dm = &dims[d];
+    dm->n = 0;
+    if (d == D_POLICY) {
+        char buf[64], *save = 0;
+        snprintf(buf, sizeof buf, "%s", eq + 1);
+        for (char *s = strtok_r(buf, ",", &save); s; s = strtok_r(0, ",", &save)) {
+            const int p = workload_lookup(policy_names, POLICY_COUNT, s);
+            if (p < 0 || dm->n == POLICY_COUNT) return -1;
+            dm->v[dm->n++] = (unsigned)p;
+        }
+        return dm->n ? 0 : -1;
+    }
+    unsigned lo, hi, step;
+    if (sscanf(eq + 1, "%u:%u:%u", &lo, &hi, &step) != 3) {
+        if (sscanf(eq + 1, "%u", &lo) != 1) return -1;
+        hi = lo; step = 1;
+    }
+    if (!step || lo < 10 || hi < lo || hi > 65535) return -1;
+    for (unsigned v = lo; v <= hi; v += step) {
+        if (dm->n == sizeof dm->v / sizeof dm->v[0]) return -1;
+        dm->v[dm->n++] = v;
+    }
+    return 0;
+}
+
+static uint64_t rng = 1;
+
+static uint32_t rnd(void)
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return (uint32_t)((rng * 2685821657736338717ULL) >> 32);
+}
+
+/* The whole grid, or *sample* points drawn from it */
+static setting_t *settings(const dim_t *dims, size_t sample, size_t *n)
+{
+    size_t grid = 1;
+    for (int d = 0; d < D_COUNT; d++) grid *= dims[d].n;
+    *n = sample ? sample : grid;
+
+    setting_t *set = calloc(*n, sizeof *set);
+    if (!set) { fprintf(stderr, "sweep: out of memory\n"); exit(2); }
+    for (size_t i = 0; i < *n; i++) {
+        size_t k = i;
+        for (int d = 0; d < D_COUNT; d++) {
+            const unsigned j = sample ? rnd() % dims[d].n : (unsigned)(k % dims[d].n);
+            k /= dims[d].n;
+            set[i].v[d] = dims[d].v[j];
+        }
+    }
+    return set;
+}
+
+static int by_wait(const void *a, const void *b)
+{
+    const setting_t *x = a, *y = b;
+    if (x->wait_avg != y->wait_avg) return x->wait_avg < y->wait_avg ? -1 : 1;
+    return (x->wait_p95 > y->wait_p95) - (x->wait_p95 < y->wait_p95);
+}
+
+static double wall_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    wl_params_t base;
+    dim_t       dims[D_COUNT];
+    unsigned    seeds = 5, top = 10;
+    long        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t      sample = 0;
+    int         opt;
+
+    workload_defaults(&base);
+    memset(dims, 0, sizeof dims);
+    dims[D_FLOOR].v[0]  = base.floor_ms;
+    dims[D_OPEN].v[0]   = base.door_open_ms;
+    dims[D_CLOSED].v[0] = base.door_closed_ms;
+    dims[D_POLICY].v[0] = (unsigned)base.policy;
+    for (int d = 0; d < D_COUNT; d++) dims[d].n = 1;
+
+    while ((opt = getopt(argc, argv, "g:R:n:j:t:w:f:a:D:c:S:")) != -1) {
+        switch (opt) {
+        case 'g': if (parse_dim(dims, optarg)) goto usage;     break;
+        case 'R': sample = strtoul(optarg, 0, 0);              break;
+        case 'n': seeds  = (unsigned)atoi(optarg);             break;
+        case 'j': threads = atol(optarg);                      break;
+        case 't': top    = (unsigned)atoi(optarg);             break;
+        case 'w':
+            if ((base.workload = workload_lookup(workload_names, W_COUNT, optarg)) < 0) goto usage;
+            break;
+        case 'f': base.floors   = (unsigned)atoi(optarg);      break;
+        case 'a': base.per_hour = atof(optarg);                break;
+        case 'D': base.hours    = atof(optarg);                break;
+        case 'c': base.capacity = (unsigned)atoi(optarg);      break;
+        case 'S': base.seed     = strtoull(optarg, 0, 0);      break;
+        default:  goto usage;
+        }
+    }
+    if (optind != argc || !seeds || threads < 1 || base.floors < 2 || base.floors > 100 ||
+        base.per_hour <= 0 || base.hours <= 0 || !base.capacity)
+        goto usage;
+    rng = base.seed ? base.seed : 1;
+
+    size_t     n_set;
+    setting_t *set     = settings(dims, sample, &n_set);
+    const size_t n_tasks = n_set * seeds;
+    if ((size_t)threads > n_tasks) threads = (long)n_tasks;
+
+    pool_t    pool   = { &base, set, seeds, calloc(n_tasks, sizeof(kpi_t)), 0, (unsigned)threads };
+    worker_t *w      = calloc((size_t)threads, sizeof *w);
+    if (!pool.result || !w) { fprintf(stderr, "sweep: out of memory\n"); return 2; }
+
+    const double t0 = wall_s();
+    run_pool(&pool, n_tasks, w);
+    const double wall = wall_s() - t0;
+
+    for (size_t i = 0; i < n_set; i++) {
+        setting_t *s = &set[i];
+        for (unsigned j = 0; j < seeds; j++) {
+            const kpi_t *k = &pool.result[i * seeds + j];
+            s->wait_avg    += k->wait.avg / seeds;
+            s->wait_p95    += k->wait.p95 / seeds;
+            s->journey_avg += k->journey.avg / seeds;
+            s->hc5         += (double)k->hc5 / seeds;
+            s->undelivered += k->arrived - k->delivered;
+        }
+    }
+    qsort(set, n_set, sizeof *set, by_wait);
+
+    printf("%s, %u floors, %.0f pax/h, %.1f h, %zu settings x %u seeds\n",
+           workload_names[base.workload], base.floors, base.per_hour, base.hours, n_set, seeds);
+    printf("%4s %-7s %6s %6s %6s  %8s %8s %8s %6s %6s\n", "rank", "policy", "floor",
+           "open", "closed", "wait avg", "wait p95", "journey", "HC5", "left");
+    for (size_t i = 0; i < n_set && i < top; i++) {
+        const setting_t *s = &set[i];
+        printf("%4zu %-7s %6u %6u %6u  %8.1f %8.1f %8.1f %6.1f %6zu\n", i + 1,
+               policy_names[s->v[D_POLICY]], s->v[D_FLOOR], s->v[D_OPEN], s->v[D_CLOSED],
+               s->wait_avg, s->wait_p95, s->journey_avg, s->hc5, s->undelivered);
+    }
+
+    uint64_t steals = 0;
+    for (long i = 0; i < threads; i++) steals += w[i].steals;
+    printf("%zu runs on %ld threads: %.3f s wall, %.0f runs/s, %" PRIu64 " steals\n",
+           n_tasks, threads, wall, n_tasks / wall, steals);
+
+    free(w);
+    free(pool.result);
+    free(set);
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-g floor|open|closed=lo:hi:step]... [-g policy=fcfs,nearest]\n"
+                    "       %*s [-R n] [-n seeds] [-j threads] [-t top]\n"
+                    "       %*s [-w up|down|lunch|inter] [-f floors] [-a per_hour] [-D hours]\n"
+                    "       %*s [-c capacity] [-S seed]\n",
+            argv[0], (int)strlen(argv[0]), "", (int)strlen(argv[0]), "", (int)strlen(argv[0]), "");
+    return 2;
+}
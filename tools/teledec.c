@@ -0,0 +1,526 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : teledec.c   — Linux decoder for the MEGA telemetry stream
+ * Purpose  : Read COBS frames from a serial device or a capture file,
+ *            print every record or aggregate them (-s).
+ * Licence  : MIT
+ *
+ *   teledec [-s] [-x] [-T | -L] [-b baud] <tty|file|->
+ *
+ *   -s   summary only (counts, state dwell, timing min/avg/max,
+ *        UNO sleep ratio, lowest stack headroom per board)
+ *   -x   also dump each decoded frame in hex
+ *   -T   ask for a trace dump (firmware built with TRACE_ENABLE=1):
+ *        sends 'T' to the MEGA, which also makes the UNO dump on
+ *        its own USB port — run a second teledec on that one
+ *   -L   ask for the event log (evlog.h): sends 'L' to the MEGA,
+ *        which answers with every trip, fault, emergency and boot
+ *        it has in EEPROM, oldest first
+ *   -b   baud rate for a tty (default TLM_BAUD)
+ ***********************************************************************/
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "telemetry.h"
+#include "evlog.h"
+#include "hal.h"
+#include "protocol.h"
+#include "record.h"
+#include "trace.h"
+
+#define MAX_FRAME   64
+
+/* Mirrors state_t in Project_MEGA/elevator.h */
+static const char *const state_names[] = { "IDLE", "MOVING", "DOOR", "EMERGENCY" };
+#define N_STATES (sizeof state_names / sizeof state_names[0])
+
+static const char *state_name(uint8_t s)
+{
+    return s < N_STATES ? state_names[s] : "?";
+}
+
+static const char *spi_name(uint8_t op)
+{
+    switch (op) {
+    case CMD_MOVEMENT_LED_ON:     return "MOVEMENT_LED_ON";
+    case CMD_MOVEMENT_LED_OFF:    return "MOVEMENT_LED_OFF";
+    case CMD_DOOR_LED_ON:         return "DOOR_LED_ON";
+    case CMD_DOOR_LED_OFF:        return "DOOR_LED_OFF";
+    case CMD_LED_SET:             return "LED_SET";
+    case CMD_LED_FADE:            return "LED_FADE";
+    case CMD_LED_BLINK:           return "LED_BLINK";
+    case CMD_BUZZER_PLAY_ONESHOT: return "BUZZER_PLAY_ONESHOT";
+    case CMD_AUDIO_STOP:          return "AUDIO_STOP";
+    case CMD_DING:                return "DING";
+    case CMD_STATUS:              return "STATUS";
+    case CMD_POWER_STATS:         return "POWER_STATS";
+    case CMD_TRACE_DUMP:          return "TRACE_DUMP";
+    case CMD_STACK_STATS:         return "STACK_STATS";
+    case CMD_READ:                return "READ";
+    default:                      return "?";
+    }
+}
+
+static const char *reset_name(uint8_t cause)
+{
+    if (cause & HAL_RESET_WATCHDOG) return "watchdog";
+    if (cause & HAL_RESET_BROWNOUT) return "brown-out";
+    if (cause & HAL_RESET_EXTERNAL) return "external";
+    if (cause & HAL_RESET_POWER)    return "power-on";
+    return "?";
+}
+
+static const char *probe_name(uint8_t p)
+{
+    switch (p) {
+    case TLM_PROBE_FLOOR_LCD:  return "floor_lcd";
+    case TLM_PROBE_PROMPT_LCD: return "prompt_lcd";
+    case TLM_PROBE_EMG_REACT:  return "emg_react";
+    case TLM_PROBE_UNO_READY:  return "uno_ready";
+    case TLM_PROBE_BOOT:       return "boot";
+    default:                   return "?";
+    }
+}
+
+static const char *trace_name(uint8_t id)
+{
+    switch (id) {
+    case TR_FSM_STATE:     return "fsm_state";
+    case TR_SPI_BEGIN:     return "spi_begin";
+    case TR_SPI_END:       return "spi_end";
+    case TR_LCD_CMD:       return "lcd_cmd";
+    case TR_LCD_CHAR:      return "lcd_char";
+    case TR_LCD_DONE:      return "lcd_done";
+    case TR_KEY_RELEASED:  return "key_released";
+    case TR_KEY_PRESSED:   return "key_pressed";
+    case TR_KEY:           return "key";
+    case TR_ISR_TICK:      return "isr_tick";
+    case TR_ISR_EMG:       return "isr_emg";
+    case TR_ISR_UDRE:      return "isr_udre";
+    case TR_ISR_UDRE_IDLE: return "isr_udre_idle";
+    case TR_ISR_EE:        return "isr_ee";
+    case TR_DUMP:          return "dump";
+    case TR_ISR_SPI:       return "uno_isr_spi";
+    case TR_ISR_SEQ:       return "uno_isr_seq";
+    case TR_ISR_EPOCH:     return "uno_isr_epoch";
+    case TR_ISR_LED_OVF:   return "uno_isr_led_ovf";
+    case TR_ISR_LED_CMP:   return "uno_isr_led_cmp";
+    case TR_ISR_SYNTH:     return "uno_isr_synth";
+    case TR_UNO_DUMP:      return "uno_dump";
+    default:               return "?";
+    }
+}
+
+/*----------------------------------------------------------------------
+  Aggregates for -s
+  --------------------------------------------------------------------*/
+static struct {
+    unsigned long frames, bad_frames, dropped;
+    unsigned long by_type[256];
+    unsigned long spi[256];
+    unsigned long keys[256];
+    unsigned long floors;
+    /* state dwell, in ticks */
+    int           cur_state;
+    uint32_t      state_since;
+    unsigned long dwell[N_STATES];
+    unsigned long entries[N_STATES];
+    /* timing probes, in Timer-1 counts */
+    unsigned long t_n[256], t_sum[256];
+    unsigned      t_min[256], t_max[256];
+    uint32_t      first_tick, last_tick;
+    /* UNO power counters, cumulative since the UNO booted */
+    unsigned long power_n;
+    uint32_t      pw_up, pw_sleep, pw_wake;
+    /* stack, per board: lowest never-touched RAM seen */
+    unsigned long stack_n[2];
+    unsigned      stack_static[2], stack_unused_min[2];
+    /* event log dumps, per record kind */
+    unsigned long log_kinds[256];
+} agg = { .cur_state = -1 };
+
+static const char *const board_names[2] = { "mega", "uno" };
+
+/*----------------------------------------------------------------------
+  COBS
+  --------------------------------------------------------------------*/
+/** Decode *n* bytes in place; returns decoded length or -1 if malformed. */
+static int cobs_decode(uint8_t *buf, int n)
+{
+    int in = 0, out = 0;
+    while (in < n) {
+        const uint8_t code = buf[in++];
+        if (code == 0 || in + code - 1 > n) return -1;
+        for (uint8_t i = 1; i < code; i++) buf[out++] = buf[in++];
+        if (code != 0xFF && in < n) buf[out++] = 0;
+    }
+    return out;
+}
+
+static uint32_t le32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/*----------------------------------------------------------------------
+  Record handling
+  --------------------------------------------------------------------*/
+/* Trace entries carry the low byte of Timer-1; each is printed with
+   the time since the previous entry of the same dump.  The count
+   wraps every 10 ms on the MEGA and every 16.4 ms on the UNO, so a
+   longer gap shows modulo that: on the MEGA the isr_tick entries in
+   between tell.                                                    */
+static struct { int have; uint8_t t; } trace_prev;
+
+static void print_trace(const uint8_t *p, int n)
+{
+    if (!n) {                               /* start of a dump   */
+        trace_prev.have = 0;
+        printf("TRACE    dump\n");
+        return;
+    }
+    for (int i = 0; i + 3 <= n; i += 3) {
+        const uint8_t id = p[i], v = p[i + 1], t = p[i + 2];
+        const long period = (id & 0x80) ? TRACE_UNO_PERIOD : TRACE_MEGA_PERIOD;
+        const long dt     = trace_prev.have ? ((long)t - trace_prev.t + period) % period : 0;
+        trace_prev.have = 1;
+        trace_prev.t    = t;
+        printf("%sTRACE    %-16s 0x%02X  +%7ld us\n", i ? "            " : "",
+               trace_name(id), v, dt * TLM_COUNT_US);
+    }
+}
+
+static const char *log_name(uint8_t kind)
+{
+    switch (kind) {
+    case LOG_BOOT:      return "boot";
+    case LOG_TRIP:      return "trip";
+    case LOG_FAULT:     return "fault";
+    case LOG_EMERGENCY: return "emergency";
+    default:            return "?";
+    }
+}
+
+/* The count, then [seq:2][kind][a][b] records (evlog.h) */
+static void print_log(const uint8_t *p, int n)
+{
+    if (n == 2) {
+        printf("LOG      %u records\n", p[0] | p[1] << 8);
+        return;
+    }
+    for (int i = 0; i + 5 <= n; i += 5) {
+        const uint8_t kind = p[i + 2], a = p[i + 3], b = p[i + 4];
+        printf("%sLOG      #%-5u %-9s ", i ? "            " : "", p[i] | p[i + 1] << 8,
+               log_name(kind));
+        switch (kind) {
+        case LOG_BOOT:      printf("%s reset%s\n", reset_name(a), b ? ", resumed" : ""); break;
+        case LOG_TRIP:      printf("%02u -> %02u\n", a, b); break;
+        case LOG_FAULT:     printf("at %02u, asked for %02u\n", a, b); break;
+        case LOG_EMERGENCY: printf("stopped at %02u (target %02u)\n", a, b); break;
+        default:            printf("%02X %02X\n", a, b);
+        }
+    }
+}
+
+static void print_record(uint8_t type, uint32_t tick, const uint8_t *p, int n)
+{
+    printf("%10.2f  ", tick / 100.0);
+    switch (type) {
+    case TLM_BOOT:    printf("BOOT\n"); break;
+    case TLM_STATE:   printf("STATE    %s -> %s\n", state_name(p[0]), state_name(p[1])); break;
+    case TLM_FLOOR:   printf("FLOOR    %02u (target %02u)\n", p[0], p[1]); break;
+    case TLM_KEY:     printf("KEY      '%c'\n", p[0] >= 0x20 && p[0] < 0x7F ? p[0] : '?'); break;
+    case TLM_SPI:     printf("SPI      0x%02X %s\n", p[0], spi_name(p[0])); break;
+    case TLM_TIMING: {
+        const unsigned dt = p[1] | p[2] << 8;
+        if (p[0] == TLM_PROBE_UNO_READY && dt == 0xFFFF)
+            printf("TIMING   %-10s no answer, gave up\n", probe_name(p[0]));
+        else
+            printf("TIMING   %-10s %6u us\n", probe_name(p[0]), dt * TLM_COUNT_US);
+    } break;
+    case TLM_DROPPED: printf("DROPPED  %u records\n", p[0] | p[1] << 8); break;
+    case TLM_STACK:
+        printf("STACK    %-4s static %u B, never touched %u B, free now %u B\n",
+               p[0] < 2 ? board_names[p[0]] : "?", p[1] | p[2] << 8, p[3] | p[4] << 8,
+               p[5] | p[6] << 8);
+        break;
+    case TLM_TRACE:   print_trace(p, n); break;
+    case TLM_INPUT:
+        if (p[0] == REC_KEY)
+            printf("INPUT    key '%c'", p[1] >= 0x20 && p[1] < 0x7F ? p[1] : '?');
+        else
+            printf("INPUT    emergency seen");
+        printf(", %u emergency polls since the last input\n", p[2] | p[3] << 8);
+        break;
+    case TLM_LOG:     print_log(p, n); break;
+    case TLM_RESUME:
+        printf("RESUME   after %s reset: %s at floor %02u (target %02u)\n",
+               reset_name(p[0]), state_name(p[3]), p[1], p[2]);
+        break;
+    case TLM_POWER: {
+        const uint32_t up = le32(p), sl = le32(p + 4);
+        printf("POWER    UNO up %.2f s, asleep %.1f %%, %lu wakeups\n",
+               up * (TLM_COUNT_US / 1e6), up ? 100.0 * sl / up : 0.0, (unsigned long)le32(p + 8));
+    } break;
+    default:
+        printf("TYPE%02X  ", type);
+        for (int i = 0; i < n; i++) printf(" %02X", p[i]);
+        printf("\n");
+    }
+}
+
+static int payload_len(uint8_t type)
+{
+    switch (type) {
+    case TLM_BOOT:    return 0;
+    case TLM_KEY:
+    case TLM_SPI:     return 1;
+    case TLM_STATE:
+    case TLM_FLOOR:
+    case TLM_DROPPED: return 2;
+    case TLM_TIMING:  return 3;
+    case TLM_INPUT:
+    case TLM_RESUME:  return 4;
+    case TLM_STACK:   return 7;
+    case TLM_POWER:   return 12;
+    default:          return -1;          /* unknown: accept any size */
+    }
+}
+
+static void aggregate(uint8_t type, uint32_t tick, const uint8_t *p, int n)
+{
+    if (!agg.frames++) agg.first_tick = tick;
+    agg.last_tick = tick;
+    agg.by_type[type]++;
+
+    switch (type) {
+    case TLM_BOOT:
+        agg.cur_state = 0;                  /* FSM starts in ST_IDLE */
+        agg.state_since = tick;
+        agg.entries[0]++;
+        break;
+    case TLM_RESUME:                        /* right after the BOOT   */
+        if (p[3] < N_STATES) {
+            agg.entries[0]--;
+            agg.entries[p[3]]++;
+            agg.cur_state = p[3];
+        }
+        break;
+    case TLM_STATE:
+        if (agg.cur_state >= 0 && (unsigned)agg.cur_state < N_STATES)
+            agg.dwell[agg.cur_state] += tick - agg.state_since;
+        agg.cur_state = p[1];
+        agg.state_since = tick;
+        if (p[1] < N_STATES) agg.entries[p[1]]++;
+        break;
+    case TLM_LOG:
+        for (int i = 0; n != 2 && i + 5 <= n; i += 5) agg.log_kinds[p[i + 2]]++;
+        break;
+    case TLM_FLOOR:   agg.floors++; break;
+    case TLM_KEY:     agg.keys[p[0]]++; break;
+    case TLM_SPI:     agg.spi[p[0]]++; break;
+    case TLM_DROPPED: agg.dropped += p[0] | p[1] << 8; break;
+    case TLM_POWER:
+        agg.pw_up    = le32(p);
+        agg.pw_sleep = le32(p + 4);
+        agg.pw_wake  = le32(p + 8);
+        agg.power_n++;
+        break;
+    case TLM_STACK:
+        if (p[0] < 2) {
+            const unsigned unused = p[3] | p[4] << 8;
+            if (!agg.stack_n[p[0]]++ || unused < agg.stack_unused_min[p[0]])
+                agg.stack_unused_min[p[0]] = unused;
+            agg.stack_static[p[0]] = p[1] | p[2] << 8;
+        }
+        break;
+    case TLM_TIMING: {
+        const unsigned dt = p[1] | p[2] << 8;
+        const uint8_t  id = p[0];
+        if (id == TLM_PROBE_UNO_READY && dt == 0xFFFF) break;   /* no UNO */
+        if (!agg.t_n[id] || dt < agg.t_min[id]) agg.t_min[id] = dt;
+        if (dt > agg.t_max[id]) agg.t_max[id] = dt;
+        agg.t_sum[id] += dt;
+        agg.t_n[id]++;
+    } break;
+    }
+}
+
+static void print_summary(void)
+{
+    printf("frames      : %lu (%lu malformed, %lu dropped on target)\n",
+           agg.frames, agg.bad_frames, agg.dropped);
+    if (!agg.frames) return;
+    printf("span        : %.2f s\n", (agg.last_tick - agg.first_tick) / 100.0);
+    printf("boots       : %lu (%lu resumed)\n", agg.by_type[TLM_BOOT], agg.by_type[TLM_RESUME]);
+    printf("floors      : %lu\n", agg.floors);
+    if (agg.by_type[TLM_LOG])
+        printf("event log   : %lu trips, %lu faults, %lu emergencies, %lu boots\n",
+               agg.log_kinds[LOG_TRIP], agg.log_kinds[LOG_FAULT],
+               agg.log_kinds[LOG_EMERGENCY], agg.log_kinds[LOG_BOOT]);
+
+    if (agg.cur_state >= 0 && (unsigned)agg.cur_state < N_STATES)
+        agg.dwell[agg.cur_state] += agg.last_tick - agg.state_since;
+    printf("\nstate        entries    dwell[s]\n");
+    for (unsigned s = 0; s < N_STATES; s++)
+        printf("%-10s %9lu %11.2f\n", state_names[s], agg.entries[s], agg.dwell[s] / 100.0);
+
+    printf("\nspi opcode             count\n");
+    for (int op = 0; op < 256; op++)
+        if (agg.spi[op]) printf("0x%02X %-16s %6lu\n", op, spi_name(op), agg.spi[op]);
+
+    printf("\nkey   count\n");
+    for (int k = 0; k < 256; k++)
+        if (agg.keys[k]) printf("'%c' %7lu\n", k >= 0x20 && k < 0x7F ? k : '?', agg.keys[k]);
+
+    if (agg.power_n) {
+        const double s = agg.pw_up * (TLM_COUNT_US / 1e6);
+        printf("\nuno power   : asleep %.1f %% of %.2f s, %.1f wakeups/s (latest of %lu reports)\n",
+               agg.pw_up ? 100.0 * agg.pw_sleep / agg.pw_up : 0.0, s,
+               s > 0 ? agg.pw_wake / s : 0.0, agg.power_n);
+    }
+
+    for (int b = 0; b < 2; b++)
+        if (agg.stack_n[b])
+            printf("%-4s stack  : static %u B, never touched at least %u B (lowest of %lu reports)\n",
+                   board_names[b], agg.stack_static[b], agg.stack_unused_min[b], agg.stack_n[b]);
+
+    printf("\nprobe         n     min[us]   avg[us]   max[us]\n");
+    for (int id = 0; id < 256; id++) {
+        if (!agg.t_n[id]) continue;
+        printf("%-10s %6lu %10u %9lu %9u\n", probe_name(id), agg.t_n[id],
+               agg.t_min[id] * TLM_COUNT_US,
+               agg.t_sum[id] * TLM_COUNT_US / agg.t_n[id],
+               agg.t_max[id] * TLM_COUNT_US);
+    }
+}
+
+/*----------------------------------------------------------------------
+  Input
+  --------------------------------------------------------------------*/
+static speed_t baud_const(long baud)
+{
+    switch (baud) {
+    case 9600:    return B9600;
+    case 19200:   return B19200;
+    case 38400:   return B38400;
+    case 57600:   return B57600;
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 500000:  return B500000;
+    case 1000000: return B1000000;
+    default:      return 0;
+    }
+}
+
+static int open_input(const char *path, long baud, int rw)
+{
+    if (!strcmp(path, "-")) return STDIN_FILENO;
+
+    const int fd = open(path, (rw ? O_RDWR : O_RDONLY) | O_NOCTTY);
+    if (fd < 0) { perror(path); return -1; }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISCHR(st.st_mode) && isatty(fd)) {
+        struct termios tio;
+        const speed_t  sp = baud_const(baud);
+        if (!sp) { fprintf(stderr, "unsupported baud %ld\n", baud); close(fd); return -1; }
+        if (tcgetattr(fd, &tio) < 0) { perror("tcgetattr"); close(fd); return -1; }
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, sp);
+        cfsetospeed(&tio, sp);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN]  = 1;
+        tio.c_cc[VTIME] = 0;
+        if (tcsetattr(fd, TCSANOW, &tio) < 0) { perror("tcsetattr"); close(fd); return -1; }
+        tcflush(fd, TCIFLUSH);
+    }
+    return fd;
+}
+
+int main(int argc, char **argv)
+{
+    int  summary = 0, hex = 0, opt;
+    char ask = 0;                           /* command byte to send */
+    long baud = TLM_BAUD;
+
+    while ((opt = getopt(argc, argv, "sxTLb:")) != -1) {
+        switch (opt) {
+        case 's': summary = 1; break;
+        case 'x': hex = 1; break;
+        case 'T': ask = TRACE_DUMP_CHAR; break;
+        case 'L': ask = EVLOG_DUMP_CHAR; break;
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: %s [-s] [-x] [-T | -L] [-b baud] <tty|file|->\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-s] [-x] [-T | -L] [-b baud] <tty|file|->\n", argv[0]);
+        return 2;
+    }
+
+    const int fd = open_input(argv[optind], baud, ask != 0);
+    if (fd < 0) return 1;
+    if (ask && write(fd, &ask, 1) != 1) { perror("write"); return 1; }
+
+    uint8_t frame[MAX_FRAME];
+    int     flen = 0, overrun = 0;
+    uint8_t chunk[512];
+    ssize_t got;
+
+    while ((got = read(fd, chunk, sizeof chunk)) != 0) {
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            perror("read");
+            break;
+        }
+        for (ssize_t i = 0; i < got; i++) {
+            const uint8_t b = chunk[i];
+            if (b != 0) {
+                if (flen < MAX_FRAME) frame[flen++] = b;
+                else overrun = 1;
+                continue;
+            }
+            /* delimiter: decode what we have */
+            const int n = overrun ? -1 : cobs_decode(frame, flen);
+            const int was_empty = (flen == 0);
+            flen = 0;
+            overrun = 0;
+            if (was_empty) continue;               /* back-to-back 0x00 */
+
+            const int want = n >= TLM_HEADER_LEN ? payload_len(frame[0]) : 0;
+            if (n < TLM_HEADER_LEN || (want >= 0 && n != TLM_HEADER_LEN + want)) {
+                agg.bad_frames++;
+                if (!summary) printf("           <malformed frame>\n");
+                continue;
+            }
+            const uint8_t  type = frame[0];
+            const uint32_t tick = frame[1] | frame[2] << 8 | frame[3] << 16 |
+                                  (uint32_t)frame[4] << 24;
+            aggregate(type, tick, frame + TLM_HEADER_LEN, n - TLM_HEADER_LEN);
+            if (!summary) {
+                if (hex) {
+                    printf("          ");
+                    for (int k = 0; k < n; k++) printf(" %02X", frame[k]);
+                    printf("\n");
+                }
+                print_record(type, tick, frame + TLM_HEADER_LEN, n - TLM_HEADER_LEN);
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (summary) print_summary();
+    if (fd != STDIN_FILENO) close(fd);
+    return 0;
+}
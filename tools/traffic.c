@@ -0,0 +1,142 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : traffic.c   — passenger workloads and service KPIs
+ * Purpose  : Drive Project_MEGA/elevator.c (fake HAL, event calendar)
+ *            with a standard arrival pattern and measure how well it
+ *            serves the building: waiting time, journey time and
+ *            handling capacity.  The engine is workload.c.
+ * Licence  : MIT
+ *
+ *   traffic [-w workload] [-p policy] [-f floors] [-a per_hour]
+ *           [-D hours] [-c capacity] [-S seed] [-j]
+ *   traffic -s [-p ...] [-f ...] [-a ...] [-D ...] [-c ...] [-S ...] [-j]
+ *
+ *   -w   up (up-peak: lobby to the floors), down (down-peak), lunch
+ *        (40 % up, 40 % down, 20 % between floors) or inter (any floor
+ *        to any other); default inter
+ *   -p   dispatch policy, fcfs or nearest (default fcfs; workload.h)
+ *   -f   floors served, lobby = 0 (2..100, default 10)
+ *   -a   passengers per hour, Poisson (default 60)
+ *   -D   hours of arrivals (default 2); the run goes on until everybody
+ *        is delivered, or for as long again
+ *   -c   car capacity in passengers (default 8)
+ *   -s   the four workloads in turn, one line each
+ *   -j   one JSON object per run instead of the table
+ *
+ * Wait, journey and HC5 are defined in workload.h.  Below the table,
+ * the EEPROM cell written most in each run, and how many years it
+ * would take to reach EE_ENDURANCE at that traffic around the clock
+ * (Code.md 4.13).
+ ***********************************************************************/
+#define _POSIX_C_SOURCE 199309L
+#include <inttypes.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "workload.h"
+
+#define EE_ENDURANCE   100000.0        /* ATmega2560 EEPROM, cycles */
+
+/* Arrivals last r->hours; the drain after them is a rounding error */
+static double wear_years(const wl_params_t *r, const kpi_t *k)
+{
+    const double per_hour = k->nv_hot / r->hours;
+    return per_hour > 0 ? EE_ENDURANCE / (per_hour * 24 * 365) : INFINITY;
+}
+
+/*----------------------------------------------------------------------
+  Output
+  --------------------------------------------------------------------*/
+static void print_header(void)
+{
+    printf("%-6s %6s %6s %7s %9s  %-20s  %-20s %5s\n", "load", "floors", "pax/h",
+           "pax", "delivered", "wait avg/p95/max s", "journey avg/p95/max s", "HC5");
+}
+
+static void print_row(const wl_params_t *r, const kpi_t *k)
+{
+    printf("%-6s %6u %6.0f %7zu %9zu  %6.1f %6.1f %6.1f  %6.1f %6.1f %6.1f %5u\n",
+           workload_names[r->workload], r->floors, r->per_hour, k->arrived, k->delivered,
+           k->wait.avg, k->wait.p95, k->wait.max,
+           k->journey.avg, k->journey.p95, k->journey.max, k->hc5);
+}
+
+static void print_wear(const wl_params_t *r, const kpi_t *k)
+{
+    printf("%-6s eeprom 0x%03X: %u writes, %.1f/h -> %.1f years to %.0fk cycles\n",
+           workload_names[r->workload], k->nv_hot_addr, k->nv_hot, k->nv_hot / r->hours,
+           wear_years(r, k), EE_ENDURANCE / 1000);
+}
+
+static void print_json(const wl_params_t *r, const kpi_t *k)
+{
+    printf("{\"workload\":\"%s\",\"policy\":\"%s\",\"floors\":%u,\"per_hour\":%.1f,\"hours\":%.2f,"
+           "\"capacity\":%u,\"seed\":%" PRIu64 ",\"arrived\":%zu,\"delivered\":%zu,"
+           "\"wait_avg\":%.2f,\"wait_p95\":%.2f,\"wait_max\":%.2f,"
+           "\"journey_avg\":%.2f,\"journey_p95\":%.2f,\"journey_max\":%.2f,"
+           "\"hc5\":%u,\"trips\":%" PRIu64 ",\"nv_hot\":%u,\"nv_hot_addr\":%u,"
+           "\"nv_years\":%.1f,\"simulated_s\":%.1f,\"wall_s\":%.4f}\n",
+           workload_names[r->workload], policy_names[r->policy], r->floors, r->per_hour,
+           r->hours, r->capacity,
+           r->seed, k->arrived, k->delivered, k->wait.avg, k->wait.p95, k->wait.max,
+           k->journey.avg, k->journey.p95, k->journey.max, k->hc5, k->trips,
+           k->nv_hot, k->nv_hot_addr, wear_years(r, k), k->simulated_s, k->wall_s);
+}
+
+int main(int argc, char **argv)
+{
+    wl_params_t r;
+    int suite = 0, json = 0, opt;
+
+    workload_defaults(&r);
+    while ((opt = getopt(argc, argv, "w:p:f:a:D:c:S:sj")) != -1) {
+        switch (opt) {
+        case 'w':
+            if ((r.workload = workload_lookup(workload_names, W_COUNT, optarg)) < 0) goto usage;
+            break;
+        case 'p':
+            if ((r.policy = workload_lookup(policy_names, POLICY_COUNT, optarg)) < 0) goto usage;
+            break;
+        case 'f': r.floors   = (unsigned)atoi(optarg);   break;
+        case 'a': r.per_hour = atof(optarg);             break;
+        case 'D': r.hours    = atof(optarg);             break;
+        case 'c': r.capacity = (unsigned)atoi(optarg);   break;
+        case 'S': r.seed     = strtoull(optarg, 0, 0);   break;
+        case 's': suite      = 1;                        break;
+        case 'j': json       = 1;                        break;
+        default:  goto usage;
+        }
+    }
+    if (optind != argc || r.floors < 2 || r.floors > 100 || r.per_hour <= 0 ||
+        r.hours <= 0 || !r.capacity)
+        goto usage;
+
+    if (!json) print_header();
+    const int first = suite ? 0 : r.workload, last = suite ? W_COUNT - 1 : r.workload;
+    kpi_t k[W_COUNT];
+    for (int w = first; w <= last; w++) {
+        r.workload = w;
+        k[w] = workload_run(&r);
+        if (json) print_json(&r, &k[w]);
+        else      print_row(&r, &k[w]);
+    }
+    if (!json) {
+        putchar('\n');
+        for (int w = first; w <= last; w++) {
+            r.workload = w;
+            print_wear(&r, &k[w]);
+        }
+    }
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-w up|down|lunch|inter] [-p fcfs|nearest] [-f floors]\n"
+                    "       %*s [-a per_hour] [-D hours] [-c capacity] [-S seed] [-j]\n"
+                    "       %s -s [options]   all four workloads\n",
+            argv[0], (int)strlen(argv[0]), "", argv[0]);
+    return 2;
+}
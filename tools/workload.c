@@ -0,0 +1,355 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : workload.c   — passenger workloads and service KPIs
+ * Licence  : MIT
+ *
+ * See workload.h.  The run state lives on the caller's stack and the
+ * simulator (hal_sim.c) is per thread, so workload_run() is reentrant
+ * across threads.  Built with -DELEVATOR_TUNING=1 so that the timing
+ * in elevator.h comes from the parameters.
+ ***********************************************************************/
+#define _POSIX_C_SOURCE 199309L
+#include <math.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "elevator.h"
+#include "evlog.h"
+#include "hal.h"
+#include "hal_sim.h"
+#include "persist.h"
+#include "telemetry.h"
+#include "workload.h"
+
+#define KEY_THINK_MS   300             /* per key typed             */
+#define HC_WINDOW_US   (300ULL * 1000000)
+
+const char *const workload_names[W_COUNT]  = { "up", "down", "lunch", "inter" };
+const char *const policy_names[POLICY_COUNT] = { "fcfs", "nearest" };
+
+__thread elevator_tuning_t elevator_tuning = { 250, 5000, 1500 };
+
+typedef struct {
+    uint64_t arrive_us, board_us, done_us;
+    uint8_t  from, to;
+    uint8_t  state;                    /* P_WAITING, P_RIDING, P_DONE */
+} pax_t;
+
+enum { P_WAITING, P_RIDING, P_DONE };
+
+typedef struct {
+    wl_params_t p;
+
+    elevator_t lift;
+    uint64_t   rng;
+    uint64_t   end_us, stop_us;
+    pax_t     *pax;
+    size_t     n_pax, cap_pax;
+    size_t     first_open;             /* all before are P_DONE     */
+    unsigned   riders;
+    char       pending[2];
+    uint8_t    n_pending;
+    uint64_t   trips;
+    jmp_buf    over;
+} run_t;
+
+void workload_defaults(wl_params_t *p)
+{
+    memset(p, 0, sizeof *p);
+    p->workload       = W_INTER;
+    p->policy         = POLICY_FCFS;
+    p->floors         = 10;
+    p->capacity       = 8;
+    p->per_hour       = 60;
+    p->hours          = 2;
+    p->seed           = 1;
+    p->floor_ms       = 250;
+    p->door_open_ms   = 5000;
+    p->door_closed_ms = 1500;
+}
+
+int workload_lookup(const char *const *names, int n, const char *s)
+{
+    for (int i = 0; i < n; i++)
+        if (!strcmp(s, names[i])) return i;
+    return -1;
+}
+
+/* xorshift64*: fast, and the same on every host */
+static uint32_t rnd(run_t *r)
+{
+    r->rng ^= r->rng >> 12;
+    r->rng ^= r->rng << 25;
+    r->rng ^= r->rng >> 27;
+    return (uint32_t)((r->rng * 2685821657736338717ULL) >> 32);
+}
+
+/*----------------------------------------------------------------------
+  Workloads
+  --------------------------------------------------------------------*/
+static uint8_t upper_floor(run_t *r)
+{
+    return (uint8_t)(1 + rnd(r) % (r->p.floors - 1));
+}
+
+static void origin_dest(run_t *r, uint8_t *from, uint8_t *to)
+{
+    int w = r->p.workload;
+    if (w == W_LUNCH) {
+        const unsigned u = rnd(r) % 10;
+        w = u < 4 ? W_UP : u < 8 ? W_DOWN : W_INTER;
+    }
+    switch (w) {
+    case W_UP:   *from = 0; *to = upper_floor(r); break;
+    case W_DOWN: *from = upper_floor(r); *to = 0; break;
+    default:
+        *from = (uint8_t)(rnd(r) % r->p.floors);
+        *to   = (uint8_t)((*from + 1 + rnd(r) % (r->p.floors - 1)) % r->p.floors);
+        break;
+    }
+}
+
+static uint64_t arrival_gap_us(run_t *r)
+{
+    const double u = (rnd(r) + 1.0) / 4294967296.0;
+    return (uint64_t)(-log(u) * 3600e6 / r->p.per_hour);
+}
+
+static void arrive(void *ctx, uint64_t arg)
+{
+    run_t *r = ctx;
+    (void)arg;
+
+    if (r->n_pax == r->cap_pax) {
+        r->cap_pax = r->cap_pax ? r->cap_pax * 2 : 1024;
+        r->pax = realloc(r->pax, r->cap_pax * sizeof *r->pax);
+        if (!r->pax) { fprintf(stderr, "workload: out of memory\n"); exit(2); }
+    }
+    pax_t *p = &r->pax[r->n_pax++];
+    memset(p, 0, sizeof *p);
+    p->arrive_us = sim.now_us;
+    p->state     = P_WAITING;
+    origin_dest(r, &p->from, &p->to);
+
+    const uint64_t next = sim.now_us + arrival_gap_us(r);
+    if (next < r->end_us) sim_at(next, arrive, 0);
+}
+
+/* Arrivals are over: an idle car asks dispatch() once more, and stops */
+static void last_call(void *ctx, uint64_t arg)
+{
+    (void)ctx; (void)arg;
+}
+
+static void time_up(void *ctx, uint64_t arg)
+{
+    run_t *r = ctx;
+    (void)arg;
+    longjmp(r->over, 1);
+}
+
+/*----------------------------------------------------------------------
+  Passengers at the car
+  --------------------------------------------------------------------*/
+/* Door open at *floor*: riders get out, then the queue there gets in */
+static void door_open(run_t *r, uint8_t floor)
+{
+    for (size_t i = r->first_open; i < r->n_pax; i++) {
+        pax_t *p = &r->pax[i];
+        if (p->state == P_RIDING && p->to == floor) {
+            p->state   = P_DONE;
+            p->done_us = sim.now_us;
+            r->riders--;
+        }
+    }
+    for (size_t i = r->first_open; i < r->n_pax && r->riders < r->p.capacity; i++) {
+        pax_t *p = &r->pax[i];
+        if (p->state == P_WAITING && p->from == floor) {
+            p->state    = P_RIDING;
+            p->board_us = sim.now_us;
+            r->riders++;
+        }
+    }
+    while (r->first_open < r->n_pax && r->pax[r->first_open].state == P_DONE)
+        r->first_open++;
+}
+
+/* First come, first served: riders before the queue */
+static int fcfs_target(const run_t *r)
+{
+    for (size_t i = r->first_open; i < r->n_pax; i++)
+        if (r->pax[i].state == P_RIDING) return r->pax[i].to;
+    for (size_t i = r->first_open; i < r->n_pax; i++)
+        if (r->pax[i].state == P_WAITING) return r->pax[i].from;
+    return -1;
+}
+
+/* Closest floor anybody needs, riding or waiting; the oldest on a tie */
+static int nearest_target(const run_t *r)
+{
+    const int here = r->lift.current_floor;
+    int best = -1, best_d = 0;
+
+    for (size_t i = r->first_open; i < r->n_pax; i++) {
+        const pax_t *p = &r->pax[i];
+        if (p->state == P_DONE) continue;
+        const int f = p->state == P_RIDING ? p->to : p->from;
+        const int d = abs(f - here);
+        if (best < 0 || d < best_d) { best = f; best_d = d; }
+    }
+    return best;
+}
+
+/* -1 = nobody needs the car */
+static int next_target(const run_t *r)
+{
+    return r->p.policy == POLICY_NEAREST ? nearest_target(r) : fcfs_target(r);
+}
+
+static char dispatch(void *ctx, uint32_t *think_ms)
+{
+    run_t *r = ctx;
+    *think_ms = KEY_THINK_MS;
+
+    if (strncmp(sim.lcd[1], "Press #", 7) == 0)
+        return '#';
+
+    if (!r->n_pending) {
+        door_open(r, r->lift.current_floor);          /* idle here */
+        const int target = next_target(r);
+        if (target < 0) {
+            if (sim.now_us >= r->end_us) longjmp(r->over, 1);   /* all delivered */
+            return 0;
+        }
+        r->pending[1] = (char)('0' + target / 10);
+        r->pending[0] = (char)('0' + target % 10);
+        r->n_pending  = 2;
+    }
+    return r->pending[--r->n_pending];
+}
+
+static void on_tlm(void *ctx, uint8_t type, const uint8_t *p, uint8_t len)
+{
+    run_t *r = ctx;
+    (void)len;
+
+    if (type != TLM_STATE) return;
+    if (p[1] == ST_DOOR) door_open(r, r->lift.current_floor);
+    if (p[1] == ST_IDLE) r->trips++;
+}
+
+/*----------------------------------------------------------------------
+  KPIs
+  --------------------------------------------------------------------*/
+static int by_value(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static dist_t distribution(double *v, size_t n)
+{
+    dist_t d = { 0, 0, 0 };
+    if (!n) return d;
+    qsort(v, n, sizeof *v, by_value);
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) sum += v[i];
+    d.avg = sum / n;
+    d.p95 = v[(size_t)ceil(0.95 * n) - 1];
+    d.max = v[n - 1];
+    return d;
+}
+
+static int by_done(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static kpi_t measure(const run_t *r)
+{
+    kpi_t k;
+    memset(&k, 0, sizeof k);
+    k.arrived = r->n_pax;
+    k.trips   = r->trips;
+
+    double   *wait    = malloc((r->n_pax + 1) * sizeof *wait);
+    double   *journey = malloc((r->n_pax + 1) * sizeof *journey);
+    uint64_t *done    = malloc((r->n_pax + 1) * sizeof *done);
+    if (!wait || !journey || !done) { fprintf(stderr, "workload: out of memory\n"); exit(2); }
+
+    size_t nw = 0;
+    for (size_t i = 0; i < r->n_pax; i++) {
+        const pax_t *p = &r->pax[i];
+        if (p->state != P_WAITING) wait[nw++] = (p->board_us - p->arrive_us) / 1e6;
+        if (p->state == P_DONE) {
+            journey[k.delivered] = (p->done_us - p->arrive_us) / 1e6;
+            done[k.delivered++]  = p->done_us;
+        }
+    }
+    k.wait    = distribution(wait, nw);
+    k.journey = distribution(journey, k.delivered);
+
+    /* Sliding 5-minute window over the delivery times */
+    qsort(done, k.delivered, sizeof *done, by_done);
+    for (size_t lo = 0, hi = 0; hi < k.delivered; hi++) {
+        while (done[hi] - done[lo] >= HC_WINDOW_US) lo++;
+        if (hi - lo + 1 > k.hc5) k.hc5 = (unsigned)(hi - lo + 1);
+    }
+    free(wait);
+    free(journey);
+    free(done);
+    return k;
+}
+
+static double wall_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void run_fsm(run_t *r)
+{
+    if (!setjmp(r->over))
+        for (;;) elevator_step(&r->lift);
+}
+
+kpi_t workload_run(const wl_params_t *p)
+{
+    run_t r;
+    memset(&r, 0, sizeof r);
+    r.p       = *p;
+    r.rng     = p->seed ? p->seed : 1;
+    r.end_us  = (uint64_t)(p->hours * 3600e6);
+    r.stop_us = 2 * r.end_us;
+
+    elevator_tuning.floor_ms       = p->floor_ms;
+    elevator_tuning.door_open_ms   = p->door_open_ms;
+    elevator_tuning.door_closed_ms = p->door_closed_ms;
+
+    sim_reset(dispatch, on_tlm, &r);
+    sim_at(arrival_gap_us(&r), arrive, 0);
+    sim_at(r.end_us, last_call, 0);
+    sim_at(r.stop_us, time_up, 0);
+    hal_init();
+    tlm_init();
+    if (!persist_restore(&r.lift))      /* as main.c: erased, so cold */
+        elevator_init(&r.lift);
+    evlog_init();
+    evlog_add(LOG_BOOT, hal_reset_cause(), 0);
+
+    const double t0 = wall_s();
+    run_fsm(&r);
+    kpi_t k = measure(&r);
+    k.wall_s      = wall_s() - t0;
+    k.simulated_s = sim.now_us / 1e6;
+    k.nv_hot      = sim_nv_hottest(&k.nv_hot_addr);
+
+    cal_free(&sim.cal);
+    free(r.pax);
+    return k;
+}
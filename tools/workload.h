@@ -0,0 +1,70 @@
+/***********************************************************************
+ * Project  : Elevator Simulator  (BL40A1812)
+ * File     : workload.h   — passenger workloads and service KPIs
+ * Licence  : MIT
+ *
+ * One call runs elevator.c on the fake HAL (hal_sim.h) for a stream of
+ * passengers and measures the service.  hal_sim keeps its state per
+ * thread, so runs on different threads do not interfere (tools/sweep).
+ *
+ * The controller has no hall calls: it goes where the keypad says.  A
+ * passenger therefore types their own floor to call the car (when it
+ * is elsewhere), boards when the door opens there, and types the
+ * destination.  The dispatch policy chooses which key comes next:
+ *
+ *   fcfs      the oldest rider's destination, else the oldest waiting
+ *             passenger's floor
+ *   nearest   the closest floor anybody riding or waiting needs
+ *
+ * Everybody waiting at a floor boards when the door opens, up to the
+ * car capacity.
+ *
+ *   wait      arrival → door opening at the passenger's floor (0 if
+ *             the car is idle there)
+ *   journey   arrival → door opening at the destination
+ *   HC5       most passengers delivered in any 5 minutes
+ *   wear      writes to the EEPROM cell written most (persist.h,
+ *             evlog.h)
+ ***********************************************************************/
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum { W_UP, W_DOWN, W_LUNCH, W_INTER, W_COUNT };
+enum { POLICY_FCFS, POLICY_NEAREST, POLICY_COUNT };
+
+extern const char *const workload_names[W_COUNT];
+extern const char *const policy_names[POLICY_COUNT];
+
+typedef struct {
+    int      workload, policy;
+    unsigned floors, capacity;         /* lobby = 0; 2..100 floors  */
+    double   per_hour, hours;          /* Poisson arrivals          */
+    uint64_t seed;
+
+    /* elevator.h timing (host builds with ELEVATOR_TUNING) */
+    uint16_t floor_ms, door_open_ms, door_closed_ms;
+} wl_params_t;
+
+typedef struct {
+    double   avg, p95, max;            /* seconds; p95 nearest-rank */
+} dist_t;
+
+typedef struct {
+    size_t   arrived, delivered;
+    dist_t   wait, journey;
+    unsigned hc5;
+    uint64_t trips;
+    double   simulated_s, wall_s;
+    uint32_t nv_hot;                   /* most-written EEPROM cell:  */
+    uint16_t nv_hot_addr;              /* its writes and address     */
+} kpi_t;
+
+void  workload_defaults(wl_params_t *p);    /* inter, 10 floors, 60/h,
+                                               2 h, 8 pax, fcfs     */
+int   workload_lookup(const char *const *names, int n, const char *s);  /* -1 */
+kpi_t workload_run(const wl_params_t *p);
+
+#endif /* WORKLOAD_H */